@@ -0,0 +1,816 @@
+#include "code.h"
+#include "frame.h"
+#include "parser.h"
+#include "test.h"
+
+#include <string.h>
+
+/**
+*** ## Programs
+***
+*** A program is an array of instructions. Its first instruction says
+*** which shape it was compiled for: `FUGA_OP_EXPR` for expressions, in
+*** which each part's value is the next part's receiver, and
+*** `FUGA_OP_SLOTS` for blocks, in which every slot starts over from the
+*** scope and its value is collected (`FUGA_OP_SLOT`). The last
+*** instruction is `FUGA_OP_RETURN`.
+***
+*** Each part or slot compiles to a single instruction, based on what kind
+*** of object it is:
+***
+*** - `FUGA_OP_CONST`: ints, strings and symbols evaluate to themselves;
+*** - `FUGA_OP_SEND`: msgs are sent to the receiver;
+*** - `FUGA_OP_EXPR`, `FUGA_OP_SLOTS`: nested expressions and blocks run
+***   in a frame of their own, on the same machine;
+*** - `FUGA_OP_EVAL`: anything else goes through `Fuga_eval`.
+***
+*** Nested code gets its own program rather than being inlined, so that
+*** writing to it only drops its own program.
+**/
+typedef enum {
+    FUGA_OP_CONST,
+    FUGA_OP_SEND,
+    FUGA_OP_EVAL,
+    FUGA_OP_EXPR,
+    FUGA_OP_SLOTS,
+    FUGA_OP_RESET,
+    FUGA_OP_DOC,
+    FUGA_OP_PROTODOC,
+    FUGA_OP_UNDOC,
+    FUGA_OP_SLOT,
+    FUGA_OP_RETURN
+} FugaOp;
+
+typedef struct FugaInstr FugaInstr;
+struct FugaInstr {
+    FugaOp op;
+    void*  arg;
+};
+
+/**
+*** ### FugaCodeMode
+***
+*** What a frame does with the values of a block's slots. Expressions are
+*** always `FUGA_CODE_EXPR`.
+**/
+typedef enum {
+    FUGA_CODE_EXPR,
+    FUGA_CODE_SLOTS,    // append non-nil values to a new object
+    FUGA_CODE_IN,       // keep the last value
+    FUGA_CODE_DO        // keep the last value, and ignore docs
+} FugaCodeMode;
+
+/**
+*** ### FugaCodeFrame
+***
+*** The state of one expression or block being evaluated. `pc` is only
+*** up to date for frames below the top one, where it's the instruction
+*** to return to.
+***
+*** A block evaluates in a scope of its own, a clone of the enclosing scope
+*** with `_this` set. Most of the time nothing ever sees that scope, so it
+*** isn't made until something might: while `this` is set, `scope` is
+*** still the enclosing scope, and `this` is what `_this` will be (see
+*** `FugaCode_scope`).
+**/
+typedef struct FugaCodeFrame FugaCodeFrame;
+struct FugaCodeFrame {
+    FugaInstr*   program;
+    FugaInstr*   pc;
+    void*        code;
+    void*        recv;
+    void*        scope;
+    void*        result;
+    void*        this;
+    FugaCodeMode mode;
+    bool         hasDoc;
+};
+
+#define FUGA_CODE_FRAMES 16
+
+static FugaInstr FugaCode_item(void* value)
+{
+    FugaInstr instr = {.op = FUGA_OP_EVAL, .arg = value};
+    if (Fuga_isInt(value) || Fuga_isString(value) || Fuga_isSymbol(value))
+        instr.op = FUGA_OP_CONST;
+    else if (Fuga_isMsg(value))
+        instr.op = FUGA_OP_SEND;
+    else if (Fuga_isLazy(value) || FugaCode_isCompiled(value))
+        instr.op = FUGA_OP_EVAL;
+    else if (Fuga_isExpr(value))
+        instr.op = FUGA_OP_EXPR;
+    else
+        instr.op = FUGA_OP_SLOTS;
+    return instr;
+}
+
+/**
+*** ### FugaCode_compile
+***
+*** Compile the slots of `self` into a program of the given shape, and
+*** keep it with them. Block slots that have docs, or names (whose docs
+*** may come from the proto), set `_doc` first, and the next slot without
+*** one clears it again.
+**/
+static FugaInstr* FugaCode_compile(void* self, bool expr)
+{
+    FugaSlots* slots  = FUGA_HEADER(self)->slots;
+    size_t     length = FugaSlots_length(slots);
+    FugaInstr* program = FugaSlots_code_(slots, 4*length + 2,
+                                         sizeof(FugaInstr));
+    FugaInstr* pc = program;
+    bool mayHaveDoc = false;
+
+    pc++->op = expr ? FUGA_OP_EXPR : FUGA_OP_SLOTS;
+    for (size_t i = 0; i < length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(slots, i);
+        if (!expr) {
+            if (slot.doc) {
+                *pc++ = (FugaInstr){.op = FUGA_OP_DOC, .arg = slot.doc};
+                mayHaveDoc = true;
+            } else if (slot.name) {
+                *pc++ = (FugaInstr){.op = FUGA_OP_PROTODOC, .arg = slot.name};
+                mayHaveDoc = true;
+            } else if (mayHaveDoc) {
+                pc++->op = FUGA_OP_UNDOC;
+                mayHaveDoc = false;
+            }
+            pc++->op = FUGA_OP_RESET;
+        }
+        *pc++ = FugaCode_item(slot.value);
+        if (!expr)
+            pc++->op = FUGA_OP_SLOT;
+    }
+    pc->op = FUGA_OP_RETURN;
+    return program;
+}
+
+/**
+*** ### FugaCode_enter
+***
+*** Set up `frame` to evaluate `self`. Returns NULL if the frame is ready
+*** to run, or else the value of the whole evaluation (which may be a
+*** raised exception), when there is nothing to run.
+**/
+static void* FugaCode_enter(
+    FugaCodeFrame* frame,
+    void* self,
+    FugaCodeMode mode,
+    void* recv,
+    void* scope
+) {
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    size_t length = slots ? FugaSlots_length(slots) : 0;
+    frame->code   = self;
+    frame->mode   = mode;
+    frame->recv   = recv;
+    frame->scope  = scope;
+    frame->result = FUGA->nil;
+    frame->this   = NULL;
+    frame->hasDoc = false;
+
+    switch (mode) {
+    case FUGA_CODE_EXPR:
+        if (!length)
+            FUGA_RAISE(FUGA->ValueError,
+                "Expr eval: can't evaluate empty expression"
+            );
+        break;
+    case FUGA_CODE_SLOTS:
+        frame->result = Fuga_clone(FUGA->Object);
+        if (!length)
+            return frame->result;
+        frame->this = frame->result;
+        FugaSlots_reserve(FUGA_HEADER(frame->result)->slots, length, 0);
+        break;
+    case FUGA_CODE_IN:
+        if (!length)
+            return FUGA->nil;
+        frame->this = scope;
+        break;
+    case FUGA_CODE_DO:
+        if (!length)
+            return FUGA->nil;
+        break;
+    }
+
+    bool expr = mode == FUGA_CODE_EXPR;
+    FugaInstr* program = FugaSlots_code(slots);
+    if (!program || (program->op == FUGA_OP_EXPR) != expr)
+        program = FugaCode_compile(self, expr);
+    frame->program = FugaSlots_retainCode(program);
+    frame->pc = program + 1;
+    return NULL;
+}
+
+/**
+*** ### FugaCode_scope
+***
+*** Make the frame's own scope, if it hasn't been made yet.
+**/
+static void* FugaCode_scope(FugaCodeFrame* frame)
+{
+    if (frame->this) {
+        void* scope = Fuga_clone(frame->scope);
+        FUGA_CHECK(scope);
+        FUGA_CHECK(Fuga_setS(scope, "_this", frame->this));
+        if (frame->recv == frame->scope)
+            frame->recv = scope;
+        frame->scope = scope;
+        frame->this  = NULL;
+    }
+    return frame->scope;
+}
+
+/**
+*** ### FugaCode_peek
+***
+*** Evaluate a msg that only reads a plain value (not a method) from the
+*** enclosing `scope` of a frame whose own scope hasn't been made: the
+*** frame's scope would only add `_this`. Returns NULL if the msg needs
+*** the frame's own scope after all.
+**/
+static void* FugaCode_peek(FugaMsg* msg, void* scope)
+{
+    FugaSymbol* name = msg->name;
+    if (Fuga_length(msg) || !Fuga_isSymbol(name) || name->data[0] == '_')
+        return NULL;
+    void* value = FugaFrame_get(scope, name, msg->depth, msg->offset);
+    if (!value)
+        return NULL;
+    value = Fuga_need(value);
+    return Fuga_isMethod(value) ? NULL : value;
+}
+
+/**
+*** ### FugaCode_run
+***
+*** The machine. Frames live in `local` until they don't fit anymore, then
+*** on the heap. Instructions are dispatched through a table of labels
+*** where the compiler supports it, and through a switch otherwise.
+***
+*** With `tail` set, a msg that gives the value of the whole evaluation
+*** (the last part of an expression, or the last slot of a block evaluated
+*** for its last value) is sent with `FugaMsg_evalTail`.
+**/
+#if defined(__GNUC__) && !defined(FUGA_CODE_SWITCH)
+#   define FUGA_CODE_THREADED
+#endif
+
+#define FUGA_CODE_NEED(value)                                           \
+    do {                                                                \
+        if (Fuga_isLazy(value)) {                                       \
+            value = Fuga_need(value);                                   \
+            if (Fuga_isRaised(value)) {                                 \
+                result = value;                                         \
+                goto unwind;                                            \
+            }                                                           \
+        }                                                               \
+    } while (0)
+
+#define FUGA_CODE_CHECK(value)                                          \
+    do {                                                                \
+        if (Fuga_isRaised(value)) {                                     \
+            result = value;                                             \
+            goto unwind;                                                \
+        }                                                               \
+    } while (0)
+
+#define FUGA_CODE_SCOPE()                                               \
+    do {                                                                \
+        if (frame->this)                                                \
+            FUGA_CODE_CHECK(FugaCode_scope(frame));                     \
+    } while (0)
+
+static void* FugaCode_run(
+    void* self,
+    FugaCodeMode mode,
+    void* recv,
+    void* scope,
+    bool tail
+) {
+    FugaCodeFrame  local[FUGA_CODE_FRAMES];
+    FugaCodeFrame* frames   = local;
+    FugaCodeFrame* frame    = frames;
+    size_t         capacity = FUGA_CODE_FRAMES;
+    FugaInstr*     tailpc   = NULL;
+    FugaInstr*     pc;
+    void*          result;
+
+    result = FugaCode_enter(frame, self, mode, recv, scope);
+    if (result)
+        return result;
+    pc = frame->pc;
+    if (tail && mode != FUGA_CODE_SLOTS) {
+        for (tailpc = pc; tailpc->op != FUGA_OP_RETURN; tailpc++)
+            ;
+        tailpc -= mode == FUGA_CODE_EXPR ? 1 : 2;
+    }
+
+#ifdef FUGA_CODE_THREADED
+    __extension__ static const void* const labels[] = {
+        [FUGA_OP_CONST]     = &&op_const,
+        [FUGA_OP_SEND]      = &&op_send,
+        [FUGA_OP_EVAL]      = &&op_eval,
+        [FUGA_OP_EXPR]      = &&op_expr,
+        [FUGA_OP_SLOTS]     = &&op_slots,
+        [FUGA_OP_RESET]     = &&op_reset,
+        [FUGA_OP_DOC]       = &&op_doc,
+        [FUGA_OP_PROTODOC]  = &&op_protodoc,
+        [FUGA_OP_UNDOC]     = &&op_undoc,
+        [FUGA_OP_SLOT]      = &&op_slot,
+        [FUGA_OP_RETURN]    = &&op_return,
+    };
+#   define FUGA_CODE_NEXT   __extension__ ({ goto *labels[pc->op]; })
+#else
+#   define FUGA_CODE_NEXT   goto dispatch
+dispatch:
+    switch (pc->op) {
+    case FUGA_OP_CONST:     goto op_const;
+    case FUGA_OP_SEND:      goto op_send;
+    case FUGA_OP_EVAL:      goto op_eval;
+    case FUGA_OP_EXPR:      goto op_expr;
+    case FUGA_OP_SLOTS:     goto op_slots;
+    case FUGA_OP_RESET:     goto op_reset;
+    case FUGA_OP_DOC:       goto op_doc;
+    case FUGA_OP_PROTODOC:  goto op_protodoc;
+    case FUGA_OP_UNDOC:     goto op_undoc;
+    case FUGA_OP_SLOT:      goto op_slot;
+    case FUGA_OP_RETURN:    goto op_return;
+    }
+#endif
+    FUGA_CODE_NEXT;
+
+op_const:
+    FUGA_CODE_NEED(frame->recv);
+    frame->recv = pc->arg;
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_send:
+    FUGA_CODE_NEED(frame->recv);
+    if (frame->this) {
+        result = FugaCode_peek(pc->arg, frame->scope);
+        if (result) {
+            FUGA_CODE_CHECK(result);
+            frame->recv = result;
+            pc++;
+            FUGA_CODE_NEXT;
+        }
+        FUGA_CODE_SCOPE();
+    }
+    if (pc == tailpc && frame == frames)
+        result = FugaMsg_evalTail(pc->arg, frame->recv, frame->scope);
+    else
+        result = FugaMsg_eval_in_(pc->arg, frame->recv, frame->scope);
+    FUGA_CODE_CHECK(result);
+    frame->recv = result;
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_eval:
+    FUGA_CODE_SCOPE();
+    result = Fuga_eval(pc->arg, frame->recv, frame->scope);
+    FUGA_CODE_CHECK(result);
+    frame->recv = result;
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_expr:
+op_slots:
+    FUGA_CODE_NEED(frame->recv);
+    FUGA_CODE_SCOPE();
+    if (frame + 1 == frames + capacity) {
+        FugaCodeFrame* grown = malloc(2 * capacity * sizeof *grown);
+        memcpy(grown, frames, capacity * sizeof *grown);
+        if (frames != local)
+            free(frames);
+        frame    = grown + (frame - frames);
+        frames   = grown;
+        capacity = 2 * capacity;
+    }
+    frame->pc = pc + 1;
+    result = FugaCode_enter(frame + 1, pc->arg,
+                            pc->op == FUGA_OP_EXPR ? FUGA_CODE_EXPR
+                                                   : FUGA_CODE_SLOTS,
+                            frame->recv, frame->scope);
+    if (result) {
+        FUGA_CODE_CHECK(result);
+        frame->recv = result;
+        pc++;
+    } else {
+        frame++;
+        pc = frame->pc;
+    }
+    FUGA_CODE_NEXT;
+
+op_reset:
+    frame->recv = frame->scope;
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_doc:
+    if (frame->mode != FUGA_CODE_DO) {
+        FUGA_CODE_SCOPE();
+        result = Fuga_setS(frame->scope, "_doc", pc->arg);
+        FUGA_CODE_CHECK(result);
+        frame->hasDoc = true;
+    }
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_protodoc:
+    if (frame->mode != FUGA_CODE_DO) {
+        void* proto = FUGA_HEADER(frame->code)->proto;
+        result = proto ? Fuga_hasDoc(proto, pc->arg) : FUGA->False;
+        FUGA_CODE_CHECK(result);
+        if (Fuga_isTrue(result)) {
+            result = Fuga_getDoc(proto, pc->arg);
+            FUGA_CODE_CHECK(result);
+            FUGA_CODE_SCOPE();
+            result = Fuga_setS(frame->scope, "_doc", result);
+            FUGA_CODE_CHECK(result);
+            frame->hasDoc = true;
+            pc++;
+            FUGA_CODE_NEXT;
+        }
+    }
+    // fall through: no doc for this slot.
+
+op_undoc:
+    if (frame->hasDoc) {
+        result = Fuga_delS(frame->scope, "_doc");
+        FUGA_CODE_CHECK(result);
+        frame->hasDoc = false;
+    }
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_slot:
+    if (frame->mode == FUGA_CODE_SLOTS) {
+        if (!Fuga_isNil(frame->recv)) {
+            result = Fuga_append_(frame->result, frame->recv);
+            FUGA_CODE_CHECK(result);
+        }
+    } else {
+        frame->result = frame->recv;
+    }
+    pc++;
+    FUGA_CODE_NEXT;
+
+op_return:
+    result = frame->mode == FUGA_CODE_EXPR ? frame->recv : frame->result;
+    FugaSlots_releaseCode(frame->program);
+    if (frame == frames) {
+        if (frames != local)
+            free(frames);
+        return result;
+    }
+    frame--;
+    frame->recv = result;
+    pc = frame->pc;
+    FUGA_CODE_NEXT;
+
+unwind:
+    while (frame > frames)
+        FugaSlots_releaseCode((frame--)->program);
+    FugaSlots_releaseCode(frame->program);
+    if (frames != local)
+        free(frames);
+    return result;
+}
+
+void* FugaCode_evalExpr(void* self, void* recv, void* scope)
+{
+    ALWAYS(self); ALWAYS(recv); ALWAYS(scope);
+    FUGA_NEED(self); FUGA_NEED(recv); FUGA_NEED(scope);
+    return FugaCode_run(self, FUGA_CODE_EXPR, recv, scope, false);
+}
+
+void* FugaCode_evalSlots(void* self, void* scope)
+{
+    ALWAYS(self); ALWAYS(scope);
+    FUGA_NEED(self); FUGA_NEED(scope);
+    return FugaCode_run(self, FUGA_CODE_SLOTS, scope, scope, false);
+}
+
+void* FugaCode_evalIn(void* self, void* scope)
+{
+    ALWAYS(self); ALWAYS(scope);
+    FUGA_NEED(self); FUGA_NEED(scope);
+    return FugaCode_run(self, FUGA_CODE_IN, scope, scope, false);
+}
+
+void* FugaCode_evalDo(void* self, void* scope)
+{
+    ALWAYS(self); ALWAYS(scope);
+    FUGA_NEED(self); FUGA_NEED(scope);
+    return FugaCode_run(self, FUGA_CODE_DO, scope, scope, false);
+}
+
+void* FugaCode_evalDoTail(void* self, void* scope)
+{
+    ALWAYS(self); ALWAYS(scope);
+    FUGA_NEED(self); FUGA_NEED(scope);
+    return FugaCode_run(self, FUGA_CODE_DO, scope, scope, true);
+}
+
+void* FugaCode_evalArgs(
+    void* self,
+    void* scope,
+    size_t* argc,
+    void** argv,
+    size_t max
+) {
+    ALWAYS(self); ALWAYS(scope); ALWAYS(argc); ALWAYS(argv);
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    size_t length = slots ? FugaSlots_length(slots) : 0;
+    *argc = 0;
+    for (size_t i = 0; i < length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(slots, i);
+        void* value = slot.value;
+        if (slot.name || slot.doc)
+            return FugaCode_evalSlots(self, scope);
+        if (Fuga_isMsg(value))
+            value = FugaCode_peek(value, scope);
+        else if (!Fuga_isInt(value) && !Fuga_isString(value)
+                                    && !Fuga_isSymbol(value))
+            value = NULL;
+        if (!value)
+            return FugaCode_evalSlots(self, scope);
+        FUGA_CHECK(value);
+        if (Fuga_isNil(value))
+            continue;
+        if (*argc == max)
+            return FugaCode_evalSlots(self, scope);
+        argv[(*argc)++] = value;
+    }
+    return NULL;
+}
+
+void* FugaCode_evalTail(void* self, void* recv, void* scope)
+{
+    ALWAYS(self); ALWAYS(recv); ALWAYS(scope);
+    FUGA_NEED(self); FUGA_NEED(recv); FUGA_NEED(scope);
+    if (Fuga_isMsg(self))
+        return FugaMsg_evalTail(self, recv, scope);
+    if (Fuga_isExpr(self))
+        return FugaCode_run(self, FUGA_CODE_EXPR, recv, scope, true);
+    if (FugaCode_isCompiled(self))
+        return FugaCode_evalCompiled(self, recv, scope, true);
+    return Fuga_eval(self, recv, scope);
+}
+
+// compiled code
+
+const FugaType FugaCompiled_type = {
+    "Compiled"
+};
+
+typedef struct {
+    FugaCodeFn fn;
+    void* code;
+} FugaCompiled;
+
+static void FugaCompiled_mark(void* _self)
+{
+    FugaCompiled* self = _self;
+    Fuga_mark_(self, self->code);
+}
+
+void* FugaCode_compiled_(void* code, FugaCodeFn fn)
+{
+    void* self = code;
+    ALWAYS(code); ALWAYS(fn);
+    FUGA_CHECK(code);
+    FugaCompiled* result = Fuga_clone_(FUGA->Object, sizeof(FugaCompiled));
+    Fuga_type_(result, &FugaCompiled_type);
+    Fuga_onMark_(result, FugaCompiled_mark);
+    result->fn   = fn;
+    result->code = code;
+    return result;
+}
+
+bool FugaCode_isCompiled(void* self)
+{
+    ALWAYS(self);
+    return !Fuga_isRaised(self) && Fuga_hasType_(self, &FugaCompiled_type);
+}
+
+void* FugaCode_source(void* self)
+{
+    ALWAYS(self);
+    return FugaCode_isCompiled(self) ? ((FugaCompiled*)self)->code : self;
+}
+
+void* FugaCode_evalCompiled(void* _self, void* recv, void* scope, bool tail)
+{
+    FugaCompiled* self = _self;
+    ALWAYS(self); ALWAYS(recv); ALWAYS(scope);
+    ALWAYS(FugaCode_isCompiled(self));
+    return self->fn(recv, scope, tail);
+}
+
+#ifdef TESTING
+TESTS(FugaCode_evalExpr) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    void* value = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_setS(value, "x", FUGA_INT(10))));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "value", value)));
+
+    // value x
+    void* expr = Fuga_clone(FUGA->Expr);
+    TEST(!Fuga_isRaised(Fuga_append_(expr, FUGA_MSG("value"))));
+    TEST(!Fuga_isRaised(Fuga_append_(expr, FUGA_MSG("x"))));
+    TEST(FugaInt_is_(FugaCode_evalExpr(expr, scope, scope), 10));
+    TEST(FugaSlots_code(FUGA_HEADER(expr)->slots));
+    TEST(FugaInt_is_(FugaCode_evalExpr(expr, scope, scope), 10));
+
+    // writing to the expression drops its program.
+    TEST(!Fuga_isRaised(Fuga_setI(expr, 1, FUGA_INT(20))));
+    TEST(!FugaSlots_code(FUGA_HEADER(expr)->slots));
+    TEST(FugaInt_is_(FugaCode_evalExpr(expr, scope, scope), 20));
+
+    // (1, (value x, nil), value x) -- nested blocks and expressions.
+    TEST(!Fuga_isRaised(Fuga_setI(expr, 1, FUGA_MSG("x"))));
+    void* inner = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(inner, expr)));
+    TEST(!Fuga_isRaised(Fuga_append_(inner, FUGA_MSG("nil"))));
+    void* block = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(block, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(block, inner)));
+    TEST(!Fuga_isRaised(Fuga_append_(block, expr)));
+    void* result = FugaCode_evalSlots(block, scope);
+    TEST(Fuga_hasLength_(result, 3));
+    TEST(FugaInt_is_(Fuga_getI(result, 0), 1));
+    TEST(Fuga_hasLength_(Fuga_getI(result, 1), 1));
+    TEST(FugaInt_is_(Fuga_getI(Fuga_getI(result, 1), 0), 10));
+    TEST(FugaInt_is_(Fuga_getI(result, 2), 10));
+    TEST(FugaInt_is_(FugaCode_evalIn(block, scope), 10));
+    TEST(FugaInt_is_(FugaCode_evalDo(block, scope), 10));
+
+    // exceptions come out of nested frames.
+    TEST(!Fuga_isRaised(Fuga_setI(expr, 1, FUGA_MSG("y"))));
+    TEST(Fuga_isRaised(FugaCode_evalSlots(block, scope)));
+    TEST(Fuga_isRaised(FugaCode_evalExpr(Fuga_clone(FUGA->Expr),
+                                         scope, scope)));
+    inner = Fuga_clone(FUGA->Object);
+    TEST(Fuga_hasLength_(FugaCode_evalSlots(inner, scope), 0));
+    TEST(Fuga_isNil(FugaCode_evalIn(inner, scope)));
+
+    // _this, whether or not the block's scope was needed before.
+    void* this = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(this, FUGA_MSG("value"))));
+    TEST(!Fuga_isRaised(Fuga_append_(this, FUGA_MSG("_this"))));
+    result = FugaCode_evalSlots(this, scope);
+    TEST(Fuga_hasLength_(result, 2));
+    TEST(Fuga_getI(result, 0) == value);
+    TEST(Fuga_getI(result, 1) == result);
+    TEST(FugaCode_evalIn(this, scope) == scope);
+
+    // deeper than the frames that fit on the C stack.
+    void* deep = FUGA_INT(5);
+    for (int i = 0; i < 3*FUGA_CODE_FRAMES; i++) {
+        void* outer = Fuga_clone(FUGA->Object);
+        TEST(!Fuga_isRaised(Fuga_append_(outer, deep)));
+        deep = outer;
+    }
+    result = FugaCode_evalSlots(deep, scope);
+    for (int i = 0; i < 3*FUGA_CODE_FRAMES; i++) {
+        TEST(Fuga_hasLength_(result, 1));
+        result = Fuga_getI(result, 0);
+    }
+    TEST(FugaInt_is_(result, 5));
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaCode_evalArgs) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "a", FUGA_INT(10))));
+    void* argv[2];
+    size_t argc;
+
+    // (1, a, nil) -- no args object, and no nils.
+    void* args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_MSG("a"))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_MSG("nil"))));
+    TEST(!FugaCode_evalArgs(args, scope, &argc, argv, 2));
+    TEST(argc == 2);
+    TEST(FugaInt_is_(argv[0], 1));
+    TEST(FugaInt_is_(argv[1], 10));
+
+    // (1, a, 2) -- too many to fit.
+    args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_MSG("a"))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(2))));
+    void* result = FugaCode_evalArgs(args, scope, &argc, argv, 2);
+    TEST(Fuga_hasLength_(result, 3));
+    TEST(FugaInt_is_(Fuga_getI(result, 1), 10));
+
+    // (a str) -- not a plain value, (x = a) -- a named slot.
+    args = Fuga_clone(FUGA->Object);
+    void* expr = Fuga_clone(FUGA->Expr);
+    TEST(!Fuga_isRaised(Fuga_append_(expr, FUGA_MSG("a"))));
+    TEST(!Fuga_isRaised(Fuga_append_(expr, FUGA_MSG("str"))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, expr)));
+    result = FugaCode_evalArgs(args, scope, &argc, argv, 2);
+    TEST(Fuga_hasLength_(result, 1));
+    TEST(Fuga_isString(Fuga_getI(result, 0)));
+    args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_setS(args, "x", FUGA_MSG("a"))));
+    result = FugaCode_evalArgs(args, scope, &argc, argv, 2);
+    TEST(FugaInt_is_(Fuga_getI(result, 0), 10));
+
+    // errors are raised, not skipped.
+    args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_MSG("nope"))));
+    TEST(Fuga_isRaised(FugaCode_evalArgs(args, scope, &argc, argv, 2)));
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaCode_evalTail) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    void* formals = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(formals, FUGA_MSG("x"))));
+    void* id = FugaMethod_method(scope, formals, FUGA_MSG("x"));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "id", id)));
+
+    // id(1) -- a call to a Fuga method is left to the caller.
+    FugaMsg* call = FUGA_MSG("id");
+    TEST(!Fuga_isRaised(Fuga_append_(call, FUGA_INT(1))));
+    TEST(FugaCode_evalTail(call, scope, scope) == FUGA->Tail);
+    TEST(FUGA->tail.method == id && FUGA->tail.recv == scope);
+    FUGA->tail = (FugaTail){.method = NULL};
+    TEST(FugaInt_is_(FugaCode_evalExpr(call, scope, scope), 1));
+
+    // if(true, id(1)) -- and so is the branch an if takes.
+    FugaMsg* branch = FUGA_MSG("if");
+    TEST(!Fuga_isRaised(Fuga_append_(branch, FUGA_MSG("true"))));
+    TEST(!Fuga_isRaised(Fuga_append_(branch, call)));
+    TEST(FugaCode_evalTail(branch, scope, scope) == FUGA->Tail);
+    TEST(!FUGA->tail.method && FUGA->tail.code == call);
+    FUGA->tail = (FugaTail){.method = NULL};
+
+    // but not calls to primitives, or calls that aren't last.
+    FugaMsg* print = FUGA_MSG("not");
+    TEST(!Fuga_isRaised(Fuga_append_(print, FUGA_MSG("true"))));
+    TEST(FugaCode_evalTail(print, scope, scope) == FUGA->False);
+    void* expr = Fuga_clone(FUGA->Expr);
+    TEST(!Fuga_isRaised(Fuga_append_(expr, call)));
+    TEST(!Fuga_isRaised(Fuga_append_(expr, FUGA_MSG("str"))));
+    TEST(Fuga_isString(FugaCode_evalTail(expr, scope, scope)));
+
+    // a loop made of tail calls.
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "def(loop(n), if(n == 0, n, loop(n - 1)))\n"
+        "loop(10000)"
+    );
+    void* block = FugaParser_block(parser);
+    TEST(FugaInt_is_(FugaCode_evalIn(block, scope), 0));
+    TEST(!FUGA->tail.method && !FUGA->tail.code);
+
+    Fuga_quit(self);
+}
+
+static void* FugaCode_testFn(void* recv, void* scope, bool tail)
+{
+    void* self = scope;
+    return tail ? FUGA->True : FUGA->False;
+}
+
+TESTS(FugaCode_compiled) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaMsg* x  = FUGA_MSG("x");
+    void* compiled = FugaCode_compiled_(x, FugaCode_testFn);
+    TEST(FugaCode_isCompiled(compiled));
+    TEST(!FugaCode_isCompiled(x));
+    TEST(FugaCode_source(compiled) == x);
+    TEST(FugaCode_source(x) == x);
+
+    // evaluating it calls the function, in or out of tail position.
+    TEST(Fuga_eval(compiled, scope, scope) == FUGA->False);
+    TEST(FugaCode_evalTail(compiled, scope, scope) == FUGA->True);
+
+    // as a method body, its code is resolved, and it's called in tail
+    // position.
+    void* formals = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(formals, FUGA_MSG("x"))));
+    void* method = FugaMethod_method(scope, formals, compiled);
+    TEST(x->depth == 0 && x->offset == 1);
+    void* args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(1))));
+    TEST(FugaMethod_call(method, scope, args) == FUGA->True);
+
+    Fuga_quit(self);
+}
+#endif
+
@@ -0,0 +1,119 @@
+#ifndef FUGA_CODE_H
+#define FUGA_CODE_H
+
+#include "fuga.h"
+
+/**
+*** # FugaCode
+***
+*** Fuga code is made of objects: expressions, blocks, msgs. Evaluating a
+*** block used to mean walking its slots, deciding what kind of object
+*** each one is, and doing the same again next time. Instead, the first
+*** evaluation of an expression or a block compiles its slots into a flat
+*** program, which is kept with the slots (see `FugaSlots_code`) and
+*** dropped as soon as they're written to. Programs run on a small machine
+*** with a few registers (the receiver, the scope and the result) and an
+*** explicit stack of frames, so nested expressions and blocks don't
+*** recurse on the C stack.
+***
+*** ### FugaCode_evalExpr
+***
+*** Evaluate an expression: evaluate each part in turn, with the value of
+*** the previous part as the receiver (`recv` for the first part).
+**/
+void* FugaCode_evalExpr(void* code, void* recv, void* scope);
+
+/**
+*** ### FugaCode_evalSlots
+***
+*** Evaluate each slot of a block, with `_this` set to a new object, and
+*** return that object with every non-nil value appended to it.
+**/
+void* FugaCode_evalSlots(void* code, void* scope);
+
+/**
+*** ### FugaCode_evalIn
+***
+*** Evaluate each slot of a block with `_this` set to `scope`, and return
+*** the last value (nil if there are no slots).
+**/
+void* FugaCode_evalIn(void* code, void* scope);
+
+/**
+*** ### FugaCode_evalDo
+***
+*** Evaluate each slot of a block in `scope` itself, ignoring docs, and
+*** return the last value (nil if there are no slots). This is `do`.
+**/
+void* FugaCode_evalDo(void* code, void* scope);
+
+/**
+*** ### FugaCode_evalArgs
+***
+*** Evaluate the args of a call to a strict method (see
+*** `FugaMethod_isStrict`) in `scope`. Args that are literals or plain
+*** values read from the scope go straight into `argv` (up to `max` of
+*** them), with nothing allocated: the result is NULL, and `*argc` says
+*** how many args there are. Otherwise the result is the args object,
+*** evaluated as a block with `FugaCode_evalSlots` (or a raised exception).
+**/
+void* FugaCode_evalArgs(
+    void* code,
+    void* scope,
+    size_t* argc,
+    void** argv,
+    size_t max
+);
+
+/**
+*** ### FugaCode_evalTail
+***
+*** Evaluate code in tail position: like `Fuga_eval`, except that if its
+*** value is that of a call to a Fuga method (or of the branch `if` takes,
+*** or the last slot of a `do`), it may return `FUGA->Tail` and leave that
+*** call in `FUGA->tail` for the caller to make, instead of making it.
+*** The caller is a method call's trampoline (see `FugaMethodFuga_call`),
+*** so tail calls don't nest on the C stack.
+***
+*** ### FugaCode_evalDoTail
+***
+*** `FugaCode_evalDo` in tail position.
+**/
+void* FugaCode_evalTail(void* code, void* recv, void* scope);
+void* FugaCode_evalDoTail(void* code, void* scope);
+
+/**
+*** ## Compiled code
+***
+*** `fugac` compiles the bodies of the methods a module defines to C
+*** functions ahead of time. A compiled body is an object that stands for
+*** its code: evaluating it calls the function (with `tail` set when it's
+*** evaluated in tail position, see `FugaCode_evalTail`), and whatever
+*** looks at code rather than evaluating it (`FugaFrame_resolve`, say)
+*** looks at the code it stands for.
+***
+*** ### FugaCode_compiled_
+***
+*** Make a compiled body for `code`, that evaluates it with `fn`.
+***
+*** ### FugaCode_isCompiled
+***
+*** Is `self` a compiled body?
+***
+*** ### FugaCode_source
+***
+*** The code a compiled body stands for, or `self` if it isn't one.
+***
+*** ### FugaCode_evalCompiled
+***
+*** Evaluate a compiled body.
+**/
+typedef void* (*FugaCodeFn)(void* recv, void* scope, bool tail);
+
+void* FugaCode_compiled_(void* code, FugaCodeFn fn);
+bool  FugaCode_isCompiled(void* self);
+void* FugaCode_source(void* self);
+void* FugaCode_evalCompiled(void* self, void* recv, void* scope, bool tail);
+
+#endif
+
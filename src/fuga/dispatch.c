@@ -0,0 +1,404 @@
+#include "dispatch.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// A literal a pattern expects, or an arg to look up.
+typedef struct {
+    enum {
+        FUGA_KEY_NONE,
+        FUGA_KEY_INT,
+        FUGA_KEY_STRING,
+        FUGA_KEY_SYMBOL
+    } kind;
+    size_t hash;
+    void* value;
+} FugaDispatchKey;
+
+typedef struct {
+    FugaDispatchKey key;
+    long* patterns;             // NULL for an empty bucket
+} FugaDispatchCase;
+
+// The patterns that take `arity` args.
+typedef struct {
+    long arity;
+    long position;              // the arg they're split on, or -1
+    long* all;
+    long* others;               // the ones that could match any value there
+    size_t size;                // the number of buckets (a power of two)
+    FugaDispatchCase* cases;
+} FugaDispatchGroup;
+
+struct FugaDispatch {
+    size_t length;
+    FugaDispatchGroup* groups;
+};
+
+static const long FugaDispatch_none[] = {-1};
+
+static FugaDispatchKey FugaDispatch_key(void* self)
+{
+    FugaDispatchKey key = {.kind = FUGA_KEY_NONE, .hash = 0, .value = self};
+    if (Fuga_isInt(self)) {
+        key.kind = FUGA_KEY_INT;
+        key.hash = (size_t)FugaInt_value(self);
+    } else if (Fuga_isString(self)) {
+        FugaString* string = self;
+        key.kind = FUGA_KEY_STRING;
+        key.hash = FugaString_hash(string->data, string->size);
+    } else if (Fuga_isSymbol(self)) {
+        key.kind = FUGA_KEY_SYMBOL;
+        key.hash = (size_t)self >> 4;
+    }
+    return key;
+}
+
+static bool FugaDispatchKey_equals(FugaDispatchKey a, FugaDispatchKey b)
+{
+    if (a.kind != b.kind || a.hash != b.hash)
+        return false;
+    FugaString* x = a.value;
+    FugaString* y = b.value;
+    switch (a.kind) {
+    case FUGA_KEY_INT:
+        return FugaInt_value(a.value) == FugaInt_value(b.value);
+    case FUGA_KEY_STRING:
+        return x->size == y->size && x->length == y->length
+            && !memcmp(x->data, y->data, x->size);
+    case FUGA_KEY_SYMBOL:
+        return a.value == b.value;
+    default:
+        return false;
+    }
+}
+
+// The literal a pattern slot expects, if it's a literal.
+static FugaDispatchKey FugaDispatch_literal(void* self)
+{
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    if (slots && FugaSlots_length(slots))
+        return (FugaDispatchKey){.kind = FUGA_KEY_NONE};
+    return FugaDispatch_key(self);
+}
+
+// Can a table be made with this pattern in it? And can it be left out
+// of a case because of its literals (are the rest of its slots names)?
+static bool FugaDispatch_pattern(void* self, bool* prunable)
+{
+    if (Fuga_isRaised(self) || Fuga_type(self)
+                            || FUGA_HEADER(self)->proto != FUGA->Object)
+        return false;
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    if (slots && FugaSlots_hasBySymbol(slots, FUGA_SYMBOL("match")))
+        return false;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    *prunable = true;
+    for (long i = 0; i < length; i++) {
+        void* slot = FugaSlots_getByIndex(slots, i).value;
+        if (FugaMsg_is_(slot, "~"))
+            return false;
+        if (Fuga_isMsg(slot) && !Fuga_length(slot)
+                             && FUGA_HEADER(slot)->proto == FUGA->Msg)
+            continue;
+        if (FugaDispatch_literal(slot).kind == FUGA_KEY_NONE)
+            *prunable = false;
+    }
+    return true;
+}
+
+static bool FugaDispatch_primitive(void* self, FugaMethodFn1 method)
+{
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    return slots && FugaMethod1_is_(
+        FugaSlots_valueBySymbol(slots, FUGA_SYMBOL("match")), method
+    );
+}
+
+static size_t FugaDispatch_writes(void* self)
+{
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    return slots ? FugaSlots_writes(slots) : 0;
+}
+
+size_t FugaDispatch_version(void* self, void* patterns)
+{
+    ALWAYS(self); ALWAYS(patterns);
+    return FugaDispatch_writes(FUGA->Object)
+         + FugaDispatch_writes(FUGA->Msg)
+         + FugaDispatch_writes(FUGA->Int)
+         + FugaDispatch_writes(FUGA->String)
+         + FugaDispatch_writes(FUGA->Symbol)
+         + FugaDispatch_writes(patterns);
+}
+
+// The literal pattern i expects at group->position, if it can be left
+// out of the cases for other values.
+static FugaDispatchKey FugaDispatchGroup_key(
+    FugaDispatchGroup* group,
+    void* patterns,
+    const bool* prunable,
+    long i
+) {
+    if (!prunable[i] || group->position < 0)
+        return (FugaDispatchKey){.kind = FUGA_KEY_NONE};
+    FugaSlots* slots = FUGA_HEADER(patterns)->slots;
+    void* pattern = FugaSlots_getByIndex(slots, i).value;
+    void* slot = FugaSlots_getByIndex(FUGA_HEADER(pattern)->slots,
+                                      group->position).value;
+    return FugaDispatch_literal(slot);
+}
+
+// The patterns in the group that could match an arg with this key.
+static long* FugaDispatchGroup_list(
+    FugaDispatchGroup* group,
+    void* patterns,
+    const bool* prunable,
+    FugaDispatchKey* key
+) {
+    long n = 0;
+    for (long* i = group->all; *i >= 0; i++)
+        n++;
+    long* result = malloc((n + 1) * sizeof *result);
+    long* end = result;
+    for (long* i = group->all; *i >= 0; i++) {
+        FugaDispatchKey mine = FugaDispatchGroup_key(group, patterns,
+                                                     prunable, *i);
+        if (mine.kind == FUGA_KEY_NONE
+                || (key && FugaDispatchKey_equals(mine, *key)))
+            *end++ = *i;
+    }
+    *end = -1;
+    return result;
+}
+
+static void FugaDispatchGroup_init(
+    FugaDispatchGroup* group,
+    void* patterns,
+    const bool* prunable
+) {
+    FugaSlots* slots = FUGA_HEADER(patterns)->slots;
+    long length = FugaSlots_length(slots);
+    group->all = malloc((length + 1) * sizeof(long));
+    long n = 0;
+    for (long i = 0; i < length; i++) {
+        void* pattern = FugaSlots_getByIndex(slots, i).value;
+        if (Fuga_length(pattern) == group->arity)
+            group->all[n++] = i;
+    }
+    group->all[n] = -1;
+
+    // Split on the arg where the most patterns expect a literal.
+    long most = 0;
+    long best = -1;
+    for (long position = 0; position < group->arity; position++) {
+        group->position = position;
+        long count = 0;
+        for (long* i = group->all; *i >= 0; i++)
+            count += FugaDispatchGroup_key(group, patterns, prunable, *i)
+                     .kind != FUGA_KEY_NONE;
+        if (count > most) {
+            most = count;
+            best = position;
+        }
+    }
+    group->position = best;
+    if (best < 0)
+        return;
+
+    group->others = FugaDispatchGroup_list(group, patterns, prunable, NULL);
+    group->size = 2;
+    while (group->size < 2 * (size_t)most)
+        group->size *= 2;
+    group->cases = calloc(group->size, sizeof *group->cases);
+    for (long* i = group->all; *i >= 0; i++) {
+        FugaDispatchKey key = FugaDispatchGroup_key(group, patterns,
+                                                    prunable, *i);
+        if (key.kind == FUGA_KEY_NONE)
+            continue;
+        size_t j = key.hash & (group->size - 1);
+        while (group->cases[j].patterns
+                && !FugaDispatchKey_equals(group->cases[j].key, key))
+            j = (j + 1) & (group->size - 1);
+        if (!group->cases[j].patterns) {
+            group->cases[j].key = key;
+            group->cases[j].patterns =
+                FugaDispatchGroup_list(group, patterns, prunable, &key);
+        }
+    }
+}
+
+FugaDispatch* FugaDispatch_new(void* self, void* patterns)
+{
+    ALWAYS(self); ALWAYS(patterns);
+    if (Fuga_isRaised(patterns)
+            || !FugaDispatch_primitive(FUGA->Object, FugaObject_match_)
+            || !FugaDispatch_primitive(FUGA->Msg,
+                                       (FugaMethodFn1)FugaMsg_match_)
+            || !FugaDispatch_primitive(FUGA->Int,
+                                       (FugaMethodFn1)FugaInt_match_)
+            || !FugaDispatch_primitive(FUGA->String,
+                                       (FugaMethodFn1)FugaString_match_)
+            || !FugaDispatch_primitive(FUGA->Symbol,
+                                       (FugaMethodFn1)FugaSymbol_match_))
+        return NULL;
+    FugaSlots* slots = FUGA_HEADER(patterns)->slots;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    if (length < 2)
+        return NULL;
+
+    bool* prunable = malloc(length * sizeof *prunable);
+    for (long i = 0; i < length; i++) {
+        if (!FugaDispatch_pattern(FugaSlots_getByIndex(slots, i).value,
+                                  &prunable[i])) {
+            free(prunable);
+            return NULL;
+        }
+    }
+
+    FugaDispatch* result = calloc(1, sizeof *result);
+    result->groups = calloc(length, sizeof *result->groups);
+    for (long i = 0; i < length; i++) {
+        long arity = Fuga_length(FugaSlots_getByIndex(slots, i).value);
+        size_t j = 0;
+        while (j < result->length && result->groups[j].arity != arity)
+            j++;
+        if (j < result->length)
+            continue;
+        result->groups[j].arity = arity;
+        result->length++;
+        FugaDispatchGroup_init(&result->groups[j], patterns, prunable);
+    }
+    free(prunable);
+    return result;
+}
+
+void FugaDispatch_free(FugaDispatch* self)
+{
+    if (!self)
+        return;
+    for (size_t i = 0; i < self->length; i++) {
+        FugaDispatchGroup* group = &self->groups[i];
+        for (size_t j = 0; j < group->size; j++)
+            free(group->cases[j].patterns);
+        free(group->cases);
+        free(group->others);
+        free(group->all);
+    }
+    free(self->groups);
+    free(self);
+}
+
+const long* FugaDispatch_find(FugaDispatch* self, void* args)
+{
+    ALWAYS(self); ALWAYS(args);
+    FugaSlots* slots = FUGA_HEADER(args)->slots;
+    long arity = slots ? FugaSlots_length(slots) : 0;
+    FugaDispatchGroup* group = NULL;
+    for (size_t i = 0; i < self->length && !group; i++)
+        if (self->groups[i].arity == arity)
+            group = &self->groups[i];
+    if (!group)
+        return FugaDispatch_none;
+    if (group->position < 0)
+        return group->all;
+
+    // Thunks are left for the patterns to evaluate, in order.
+    for (long i = 0; i < arity; i++)
+        if (Fuga_isLazy(FugaSlots_getByIndex(slots, i).value))
+            return group->all;
+
+    void* arg = FugaSlots_getByIndex(slots, group->position).value;
+    FugaDispatchKey key = FugaDispatch_key(arg);
+    if (key.kind == FUGA_KEY_NONE)
+        return group->others;
+    size_t mask = group->size - 1;
+    for (size_t i = key.hash & mask; group->cases[i].patterns;
+                                     i = (i + 1) & mask)
+        if (FugaDispatchKey_equals(group->cases[i].key, key))
+            return group->cases[i].patterns;
+    return group->others;
+}
+
+#ifdef TESTING
+static bool FugaDispatch_is(const long* found, const long* expected)
+{
+    while (*found == *expected && *expected >= 0)
+        found++, expected++;
+    return *found == *expected;
+}
+
+static void* FugaDispatch_block(void* self, long n, void** values)
+{
+    void* block = Fuga_clone(FUGA->Object);
+    for (long i = 0; i < n; i++)
+        Fuga_append_(block, values[i]);
+    return block;
+}
+
+TESTS(FugaDispatch_find) {
+    void* self = Fuga_init();
+
+    // f(0), f(1), f("a"), f(x), f(x, 1), f((a, b), 1), f(x, y)
+    void* patterns = Fuga_clone(FUGA->Object);
+    void* zero[]   = {FUGA_INT(0)};
+    void* one[]    = {FUGA_INT(1)};
+    void* a[]      = {FUGA_STRING("a")};
+    void* x[]      = {FUGA_MSG("x")};
+    void* x1[]     = {FUGA_MSG("x"), FUGA_INT(1)};
+    void* ab[]     = {FUGA_MSG("a"), FUGA_MSG("b")};
+    void* ab1[]    = {FugaDispatch_block(self, 2, ab), FUGA_INT(1)};
+    void* xy[]     = {FUGA_MSG("x"), FUGA_MSG("y")};
+    Fuga_append_(patterns, FugaDispatch_block(self, 1, zero));
+    Fuga_append_(patterns, FugaDispatch_block(self, 1, one));
+    Fuga_append_(patterns, FugaDispatch_block(self, 1, a));
+    Fuga_append_(patterns, FugaDispatch_block(self, 1, x));
+    Fuga_append_(patterns, FugaDispatch_block(self, 2, x1));
+    Fuga_append_(patterns, FugaDispatch_block(self, 2, ab1));
+    Fuga_append_(patterns, FugaDispatch_block(self, 2, xy));
+
+    FugaDispatch* dispatch = FugaDispatch_new(self, patterns);
+    TEST(dispatch);
+    if (dispatch) {
+        const long a1[] = {1, 3, -1};
+        const long a2[] = {2, 3, -1};
+        const long a3[] = {3, -1};
+        const long a4[] = {4, 5, 6, -1};
+        const long a5[] = {5, 6, -1};
+        const long a6[] = {-1};
+        void* b[]  = {FUGA_STRING("b")};
+        void* c1[] = {FUGA_INT(5), FUGA_INT(1)};
+        void* c2[] = {FUGA_INT(5), FUGA_INT(2)};
+        void* c3[] = {FUGA_INT(5), FUGA_INT(2), FUGA_INT(1)};
+        TEST(FugaDispatch_is(FugaDispatch_find(dispatch,
+            FugaDispatch_block(self, 1, one)), a1));
+        TEST(FugaDispatch_is(FugaDispatch_find(dispatch,
+            FugaDispatch_block(self, 1, a)), a2));
+        TEST(FugaDispatch_is(FugaDispatch_find(dispatch,
+            FugaDispatch_block(self, 1, b)), a3));
+        TEST(FugaDispatch_is(FugaDispatch_find(dispatch,
+            FugaDispatch_block(self, 2, c1)), a4));
+        TEST(FugaDispatch_is(FugaDispatch_find(dispatch,
+            FugaDispatch_block(self, 2, c2)), a5));
+        TEST(FugaDispatch_is(FugaDispatch_find(dispatch,
+            FugaDispatch_block(self, 3, c3)), a6));
+        FugaDispatch_free(dispatch);
+    }
+
+    // No tables once a primitive match is replaced.
+    size_t version = FugaDispatch_version(self, patterns);
+    TEST(!Fuga_isRaised(Fuga_setS(FUGA->Int, "match", FUGA->nil)));
+    TEST(FugaDispatch_version(self, patterns) != version);
+    TEST(!FugaDispatch_new(self, patterns));
+
+    // A pattern added (see FugaMethod_addPattern) is a write too.
+    version = FugaDispatch_version(self, patterns);
+    TEST(!Fuga_isRaised(Fuga_append_(patterns,
+        FugaDispatch_block(self, 1, one))));
+    TEST(FugaDispatch_version(self, patterns) != version);
+
+    Fuga_quit(self);
+}
+#endif
+
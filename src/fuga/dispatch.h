@@ -0,0 +1,58 @@
+#ifndef FUGA_DISPATCH_H
+#define FUGA_DISPATCH_H
+
+#include "fuga.h"
+
+/**
+*** # FugaDispatch
+***
+*** A method defined with several patterns (see `FugaMethod_addPattern`)
+*** tries them in order until one matches. A dispatch table narrows the
+*** patterns down before any of them is tried: they're grouped by how
+*** many args they take, and each group is split on the arg where most of
+*** its patterns expect a literal (an int, a string or a symbol). A call
+*** looks up its group, then the value of that arg, and only tries the
+*** patterns that could match, still in order, and still with `match`.
+***
+*** Tables are only made for methods whose patterns are all plain blocks
+*** without lazy args (`~x`), and only while Object, Msg, Int, String and
+*** Symbol have their primitive `match` methods. A pattern is only left
+*** out because of its literals if all its other slots are plain names,
+*** so that trying it couldn't have done anything but fail to match.
+***
+*** ### FugaDispatch_new
+***
+*** Make the table for the patterns in `patterns`, or return NULL if they
+*** can't have one.
+***
+*** ### FugaDispatch_free
+***
+*** Free a table.
+**/
+typedef struct FugaDispatch FugaDispatch;
+
+FugaDispatch* FugaDispatch_new(void* self, void* patterns);
+void FugaDispatch_free(FugaDispatch* self);
+
+/**
+*** ### FugaDispatch_version
+***
+*** Something that changes whenever the table for `patterns` might: a
+*** pattern is added to `patterns` (or it's otherwise written to), or a
+*** primitive `match` method is. It's a handful of counters read on each
+*** call, however many patterns there are, so the blocks in `patterns`
+*** are taken as they were when they were added: `FugaMethod_addPattern`
+*** is the way to change a method's patterns.
+**/
+size_t FugaDispatch_version(void* self, void* patterns);
+
+/**
+*** ### FugaDispatch_find
+***
+*** The indices of the patterns that could match `args`, an evaluated
+*** args object, in order, and followed by -1.
+**/
+const long* FugaDispatch_find(FugaDispatch* self, void* args);
+
+#endif
+
@@ -0,0 +1,382 @@
+#include "frame.h"
+#include "code.h"
+#include "test.h"
+
+const FugaType FugaFrame_type = {
+    "Frame"
+};
+
+// Patterns and bodies nested deeper than this aren't resolved.
+#define FUGA_FRAME_NESTING 256
+
+// A frame's captures past this many aren't resolved.
+#define FUGA_FRAME_NAMES 32
+
+typedef struct {
+    size_t call;
+} FugaFrame;
+
+void* FugaFrame_new(void* scope)
+{
+    ALWAYS(scope);
+    FUGA_CHECK(scope);
+    void* result = Fuga_cloneInline_(scope, sizeof(FugaFrame));
+    FUGA_CHECK(result);
+    Fuga_type_(result, &FugaFrame_type);
+    return result;
+}
+
+size_t FugaFrame_call(void* self)
+{
+    ALWAYS(self);
+    ALWAYS(Fuga_hasType_(self, &FugaFrame_type));
+    return ((FugaFrame*)self)->call;
+}
+
+void FugaFrame_call_(void* self, size_t call)
+{
+    ALWAYS(self);
+    ALWAYS(Fuga_hasType_(self, &FugaFrame_type));
+    ((FugaFrame*)self)->call = call;
+}
+
+void* FugaFrame_of(void* scope)
+{
+    ALWAYS(scope);
+    for (void* obj = scope; obj; obj = FUGA_HEADER(obj)->proto)
+        if (Fuga_hasType_(obj, &FugaFrame_type))
+            return obj;
+    return NULL;
+}
+
+static bool FugaFrame_isBlock(void* self)
+{
+    return !Fuga_type(self) && FUGA_HEADER(self)->proto == FUGA->Object;
+}
+
+bool FugaFrame_binds(void* self)
+{
+    ALWAYS(self);
+    if (Fuga_isRaised(self) || !FugaFrame_isBlock(self))
+        return false;
+    void* match = FUGA_SYMBOL("match");
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    if (slots && FugaSlots_hasBySymbol(slots, match))
+        return false;
+    for (long i = 0; i < length; i++) {
+        FugaMsg* msg = FugaSlots_getByIndex(slots, i).value;
+        if (!Fuga_isMsg(msg) || Fuga_length(msg)
+            || FUGA_HEADER(msg)->proto != FUGA->Msg
+            || !Fuga_isSymbol(msg->name) || msg->name == FUGA_SYMBOL("self"))
+            return false;
+        for (long j = 0; j < i; j++) {
+            FugaMsg* other = FugaSlots_getByIndex(slots, j).value;
+            if (other->name == msg->name)
+                return false;
+        }
+    }
+    FugaSlots* objects = FUGA_HEADER(FUGA->Object)->slots;
+    FugaSlots* msgs    = FUGA_HEADER(FUGA->Msg)->slots;
+    return FugaMethod1_is_(FugaSlots_valueBySymbol(objects, match),
+                           FugaObject_match_)
+        && FugaMethod1_is_(FugaSlots_valueBySymbol(msgs, match),
+                           (FugaMethodFn1)FugaMsg_match_);
+}
+
+void* FugaFrame_bind(void* scope, void* formals, void* recv, void* args)
+{
+    ALWAYS(scope); ALWAYS(formals); ALWAYS(recv); ALWAYS(args);
+    FUGA_NEED(args);
+    FugaSlots* names = FUGA_HEADER(formals)->slots;
+    long length = names ? FugaSlots_length(names) : 0;
+    if (!Fuga_hasLength_(args, length))
+        return NULL;
+
+    void* self = FugaFrame_new(scope);
+    FUGA_CHECK(self);
+    FugaSlots* slots  = FUGA_HEADER(self)->slots;
+    FugaSlots* values = FUGA_HEADER(args)->slots;
+    FugaSlots_reserve(slots, 0, length + 1);
+    FugaSlots_append_(slots, (FugaSlot){
+        .value = recv, .name = FUGA_SYMBOL("self"), .doc = NULL
+    });
+    for (long i = 0; i < length; i++) {
+        FugaMsg* msg = FugaSlots_getByIndex(names, i).value;
+        void* value = FugaSlots_getByIndex(values, i).value;
+        FUGA_NEED(value);
+        FugaSlots_append_(slots, (FugaSlot){
+            .value = value, .name = msg->name, .doc = NULL
+        });
+    }
+    return self;
+}
+
+// The names a pattern puts in a frame, in order: `self` first, then the
+// captures, in the order `FugaObject_match_` updates them into the frame.
+typedef struct {
+    void* names[FUGA_FRAME_NAMES];
+    long length;
+} FugaFrameNames;
+
+static bool FugaFrameNames_add(FugaFrameNames* names, void* name)
+{
+    for (long i = 0; i < names->length; i++)
+        if (names->names[i] == name)
+            return true;
+    if (names->length == FUGA_FRAME_NAMES)
+        return false;
+    names->names[names->length++] = name;
+    return true;
+}
+
+// Collect the names a pattern captures. Returns false if we can't tell
+// what the pattern captures without running it.
+static bool FugaFrame_captures(
+    void* pattern,
+    FugaFrameNames* names,
+    long nesting
+) {
+    if (Fuga_isRaised(pattern) || nesting > FUGA_FRAME_NESTING)
+        return false;
+    if (Fuga_isInt(pattern) || Fuga_isString(pattern))
+        return true;
+    if (Fuga_isMsg(pattern)) {
+        FugaMsg* msg = pattern;
+        if (!Fuga_length(msg))
+            return Fuga_isSymbol(msg->name)
+                && FugaFrameNames_add(names, msg->name);
+        if (FugaMsg_is_(msg, "~") && Fuga_hasLength_(msg, 1))
+            return FugaFrame_captures(Fuga_getI(msg, 0), names, nesting+1);
+        return false;
+    }
+    if (!FugaFrame_isBlock(pattern))
+        return false;
+    FugaSlots* slots = FUGA_HEADER(pattern)->slots;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    for (long i = 0; i < length; i++) {
+        void* value = FugaSlots_getByIndex(slots, i).value;
+        if (!FugaFrame_captures(value, names, nesting+1))
+            return false;
+    }
+    return true;
+}
+
+static long FugaFrame_offset(FugaSlots* slots, void* name)
+{
+    long length = slots ? FugaSlots_length(slots) : 0;
+    for (long i = 0; i < length; i++)
+        if (FugaSlots_getByIndex(slots, i).name == name)
+            return i;
+    return -1;
+}
+
+// Find the coordinates of a name used in the body. The body's own frame
+// holds `locals`; the frames of enclosing methods are in `scope`'s chain,
+// and any other scope in between that has the name makes it dynamic.
+static bool FugaFrame_locate(
+    FugaFrameNames* locals,
+    void* scope,
+    void* name,
+    long* depth,
+    long* offset
+) {
+    for (long i = 0; i < locals->length; i++) {
+        if (locals->names[i] == name) {
+            *depth = 0; *offset = i;
+            return true;
+        }
+    }
+    *depth = 1;
+    for (void* obj = scope; obj; obj = FUGA_HEADER(obj)->proto) {
+        FugaSlots* slots = FUGA_HEADER(obj)->slots;
+        if (Fuga_hasType_(obj, &FugaFrame_type)) {
+            if ((*offset = FugaFrame_offset(slots, name)) >= 0)
+                return true;
+            (*depth)++;
+        } else if (slots && FugaSlots_hasBySymbol(slots, name)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+static void FugaFrame_resolveIn(
+    FugaFrameNames* locals,
+    void* scope,
+    void* code,
+    long nesting
+) {
+    if (Fuga_isRaised(code) || nesting > FUGA_FRAME_NESTING)
+        return;
+    code = FugaCode_source(code);
+    if (Fuga_isMsg(code)) {
+        FugaMsg* msg = code;
+        msg->depth = msg->offset = -1;
+        if (!Fuga_length(msg) && Fuga_isSymbol(msg->name)
+            && !FugaFrame_locate(locals, scope, msg->name,
+                                 &msg->depth, &msg->offset))
+            msg->depth = msg->offset = -1;
+    } else if (!Fuga_isExpr(code) && !FugaFrame_isBlock(code)) {
+        return;
+    }
+    FugaSlots* slots = FUGA_HEADER(code)->slots;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    for (long i = 0; i < length; i++) {
+        void* value = FugaSlots_getByIndex(slots, i).value;
+        FugaFrame_resolveIn(locals, scope, value, nesting+1);
+    }
+}
+
+void FugaFrame_resolve(void* self, void* formals, void* body)
+{
+    ALWAYS(self); ALWAYS(formals); ALWAYS(body);
+    if (Fuga_isRaised(self) || Fuga_isRaised(formals))
+        return;
+    FugaFrameNames locals = {.length = 0};
+    FugaFrameNames_add(&locals, FUGA_SYMBOL("self"));
+    if (!FugaFrame_captures(formals, &locals, 0))
+        locals.length = 0;
+    FugaFrame_resolveIn(&locals, self, body, 0);
+}
+
+void* FugaFrame_get(void* scope, void* name, long depth, long offset)
+{
+    ALWAYS(scope); ALWAYS(name);
+    for (void* obj = scope; obj; obj = FUGA_HEADER(obj)->proto) {
+        FugaSlots* slots = FUGA_HEADER(obj)->slots;
+        if (!slots)
+            continue;
+        if (Fuga_hasType_(obj, &FugaFrame_type) && !depth--) {
+            FugaSlot slot = FugaSlots_getByIndex(slots, offset);
+            if (slot.name == name)
+                return slot.value;
+        }
+        void* value = FugaSlots_valueBySymbol(slots, name);
+        if (value)
+            return value;
+    }
+    return NULL;
+}
+
+#ifdef TESTING
+TESTS(FugaFrame_resolve) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+
+    // (a, (b, 1), ~c) -- captures a, b and c.
+    void* formals = Fuga_clone(FUGA->Object);
+    void* nested  = Fuga_clone(FUGA->Object);
+    void* lazy    = FUGA_MSG("~");
+    TEST(!Fuga_isRaised(Fuga_append_(nested, FUGA_MSG("b"))));
+    TEST(!Fuga_isRaised(Fuga_append_(nested, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(lazy, FUGA_MSG("c"))));
+    TEST(!Fuga_isRaised(Fuga_append_(formals, FUGA_MSG("a"))));
+    TEST(!Fuga_isRaised(Fuga_append_(formals, nested)));
+    TEST(!Fuga_isRaised(Fuga_append_(formals, lazy)));
+
+    // (c, self, print, f(a)) -- print and f are dynamic.
+    FugaMsg* c     = FUGA_MSG("c");
+    FugaMsg* me    = FUGA_MSG("self");
+    FugaMsg* print = FUGA_MSG("print");
+    FugaMsg* f     = FUGA_MSG("f");
+    FugaMsg* a     = FUGA_MSG("a");
+    TEST(!Fuga_isRaised(Fuga_append_(f, a)));
+    void* body = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(body, c)));
+    TEST(!Fuga_isRaised(Fuga_append_(body, me)));
+    TEST(!Fuga_isRaised(Fuga_append_(body, print)));
+    TEST(!Fuga_isRaised(Fuga_append_(body, f)));
+
+    FugaFrame_resolve(scope, formals, body);
+    TEST(c->depth == 0 && c->offset == 3);
+    TEST(me->depth == 0 && me->offset == 0);
+    TEST(a->depth == 0 && a->offset == 1);
+    TEST(print->depth == -1);
+    TEST(f->depth == -1);
+
+    // a frame of that method, and a method defined in it.
+    void* frame = FugaFrame_new(scope);
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "self", FUGA->nil)));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "a", FUGA_INT(10))));
+    void* inner = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(inner, FUGA_MSG("c"))));
+    FugaFrame_resolve(frame, inner, body);
+    TEST(c->depth == 0 && c->offset == 1);
+    TEST(a->depth == 1 && a->offset == 1);
+    TEST(me->depth == 0 && me->offset == 0);
+
+    // a pattern we can't see through leaves the body dynamic.
+    void* opaque = Fuga_clone(FUGA->Object);
+    void* call   = FUGA_MSG("g");
+    TEST(!Fuga_isRaised(Fuga_append_(call, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(opaque, call)));
+    FugaFrame_resolve(frame, opaque, body);
+    TEST(c->depth == -1);
+    TEST(me->depth == 1 && me->offset == 0);
+
+    // lookups: by coordinates, with wrong coordinates, and shadowed.
+    void* name = FUGA_SYMBOL("a");
+    TEST(FugaInt_is_(FugaFrame_get(frame, name, 0, 1), 10));
+    TEST(FugaInt_is_(FugaFrame_get(frame, name, 0, 0), 10));
+    TEST(FugaInt_is_(FugaFrame_get(frame, name, 3, 7), 10));
+    void* block = Fuga_clone(frame);
+    TEST(!Fuga_isRaised(Fuga_setS(block, "a", FUGA_INT(20))));
+    TEST(FugaInt_is_(FugaFrame_get(block, name, 0, 1), 20));
+    TEST(FugaFrame_get(block, FUGA_SYMBOL("b"), 0, 2) == NULL);
+    TEST(FugaFrame_get(block, FUGA_SYMBOL("print"), -1, -1));
+
+    // a method call looks its formals up in its frame.
+    void* two = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(two, FUGA_MSG("x"))));
+    TEST(!Fuga_isRaised(Fuga_append_(two, FUGA_MSG("y"))));
+    void* method = FugaMethod_method(scope, two, FUGA_MSG("y"));
+    void* args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(2))));
+    TEST(FugaInt_is_(FugaMethod_call(method, FUGA->nil, args), 2));
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaFrame_bind) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+
+    void* two = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(two, FUGA_MSG("x"))));
+    TEST(!Fuga_isRaised(Fuga_append_(two, FUGA_MSG("y"))));
+    TEST(FugaFrame_binds(two));
+    TEST(FugaFrame_binds(Fuga_clone(FUGA->Object)));
+
+    void* args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(1))));
+    TEST(FugaFrame_bind(scope, two, FUGA->nil, args) == NULL);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(2))));
+    void* frame = FugaFrame_bind(scope, two, FUGA->True, args);
+    TEST(Fuga_hasLength_(frame, 3));
+    TEST(FUGA_HEADER(frame)->proto == scope);
+    TEST(Fuga_getI(frame, 0) == FUGA->True);
+    TEST(FugaInt_is_(Fuga_getS(frame, "x"), 1));
+    TEST(FugaInt_is_(Fuga_getS(frame, "y"), 2));
+
+    // repeated names, self, literals and lazy names go through match.
+    void* same = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(same, FUGA_MSG("x"))));
+    TEST(!Fuga_isRaised(Fuga_append_(same, FUGA_MSG("x"))));
+    TEST(!FugaFrame_binds(same));
+    void* me = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(me, FUGA_MSG("self"))));
+    TEST(!FugaFrame_binds(me));
+    void* literal = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(literal, FUGA_INT(0))));
+    TEST(!FugaFrame_binds(literal));
+
+    // and so does everything, once match is redefined.
+    TEST(!Fuga_isRaised(Fuga_setS(FUGA->Msg, "match", FUGA->nil)));
+    TEST(!FugaFrame_binds(two));
+
+    Fuga_quit(self);
+}
+#endif
+
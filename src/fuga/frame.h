@@ -0,0 +1,92 @@
+#ifndef FUGA_FRAME_H
+#define FUGA_FRAME_H
+
+#include "fuga.h"
+
+/**
+*** # FugaFrame
+***
+*** A frame is the scope a Fuga method body runs in: a clone of the
+*** method's scope holding `self` and whatever the matching pattern
+*** captured. Frames are tagged, so they can be told apart from the other
+*** scopes (`do` blocks, `_this` objects) that show up in a scope chain.
+***
+*** Frames have a fixed layout: `self` is slot 0, and the captures follow
+*** in pattern order. Patterns made of plain names are bound straight into
+*** the frame (see `FugaFrame_bind`), in a single allocation, without
+*** sending `match` or building match results to merge into the frame.
+***
+*** When `def` or `method` creates a method, each of its bodies is
+*** resolved against its pattern: msgs that refer to `self`, to a formal,
+*** or to a name captured by an enclosing method are annotated with the
+*** coordinates of that name -- how many frames up the scope chain it
+*** lives (its depth) and where in that frame (its offset). Looking such
+*** a msg up is then an indexed load, with a cheap check on every scope
+*** it passes on the way. Names that can't be resolved ahead of time
+*** (globals, names that are assigned at runtime, patterns we don't
+*** understand) are left alone, and are looked up as usual.
+***
+*** Coordinates are only a hint: a frame is always checked for the name
+*** at that offset, so a stale or wrong annotation is slow, not wrong.
+***
+*** ### FugaFrame_new
+***
+*** Create a frame whose lexical scope is `scope`.
+**/
+void* FugaFrame_new(void* scope);
+
+/**
+*** ### FugaFrame_call
+***
+*** The id of the call a frame belongs to, 0 until it's set with
+*** `FugaFrame_call_`. A call gets its id from `FUGA->calls` when it
+*** starts, and every frame its trampoline makes (the frames of the tail
+*** calls it goes on to make, too) shares it, so that `return` can exit
+*** the call from any of them (see `FugaUnwind`).
+***
+*** ### FugaFrame_of
+***
+*** The nearest frame in the scope chain of `scope`: the frame of the
+*** method whose body `scope` is in. NULL outside of any method.
+**/
+size_t FugaFrame_call(void* self);
+void FugaFrame_call_(void* self, size_t call);
+void* FugaFrame_of(void* scope);
+
+/**
+*** ### FugaFrame_binds
+***
+*** Can a call bind its args to `formals` with `FugaFrame_bind`? It can if
+*** `formals` is a plain list of distinct names (other than `self`), and
+*** `match` hasn't been redefined for objects or msgs.
+**/
+bool FugaFrame_binds(void* formals);
+
+/**
+*** ### FugaFrame_bind
+***
+*** Create the frame of a call to a method defined in `scope`, binding
+*** `self` to `recv` and each name in `formals` to the matching arg.
+*** Returns NULL if there are too many or too few args.
+**/
+void* FugaFrame_bind(void* scope, void* formals, void* recv, void* args);
+
+/**
+*** ### FugaFrame_resolve
+***
+*** Annotate the msgs in `body`, the body of a method with pattern
+*** `formals` defined in `scope`.
+**/
+void FugaFrame_resolve(void* scope, void* formals, void* body);
+
+/**
+*** ### FugaFrame_get
+***
+*** Look up `name` from `scope`, using the coordinates `depth` and
+*** `offset`. Returns the value, or NULL if `name` isn't in the scope
+*** chain (so the caller can fall back to `Fuga_get` for the error).
+**/
+void* FugaFrame_get(void* scope, void* name, long depth, long offset);
+
+#endif
+
@@ -6,13 +6,18 @@
 #include "path.h"
 #include "thunk.h"
 #include "loader.h"
+#include "code.h"
+#include "memo.h"
+#include "platform.h"
 
 #include <string.h>
+#include <stddef.h>
 
 void FugaRoot_mark(
     void* self
 ) {
     Fuga_mark_(self, FUGA->symbols);
+    Fuga_mark_(self, FUGA->strings);
 
     Fuga_mark_(self, FUGA->Object);
     Fuga_mark_(self, FUGA->Prelude);
@@ -29,6 +34,9 @@ void FugaRoot_mark(
     Fuga_mark_(self, FUGA->False);
     Fuga_mark_(self, FUGA->Path);
     Fuga_mark_(self, FUGA->Thunk);
+    Fuga_mark_(self, FUGA->Range);
+    Fuga_mark_(self, FUGA->Iter);
+    Fuga_mark_(self, FUGA->Tail);
 
     Fuga_mark_(self, FUGA->Exception);
     Fuga_mark_(self, FUGA->TypeError);
@@ -38,11 +46,26 @@ void FugaRoot_mark(
     Fuga_mark_(self, FUGA->SyntaxError);
     Fuga_mark_(self, FUGA->SyntaxUnfinished);
     Fuga_mark_(self, FUGA->MatchError);
+    Fuga_mark_(self, FUGA->NoMatch);
+    Fuga_mark_(self, FUGA->RecursionError);
+    Fuga_mark_(self, FUGA->Break);
+    Fuga_mark_(self, FUGA->Continue);
+    Fuga_mark_(self, FUGA->Return);
+    if (FUGA->unwind.value)
+        Fuga_mark_(self, FUGA->unwind.value);
 }
 
 void Fuga_initObject    (void* self);
 void Fuga_initBool      (void* self);
 void Fuga_initException (void* self);
+void* Fuga_reserveM     (void* self, void* args);
+
+// The default stack limit, for a stack of `size` bytes (0 if unknown).
+static size_t Fuga_stackLimit(size_t size)
+{
+    size_t limit = size / 4 * 3;
+    return limit && limit < FUGA_STACK_LIMIT ? limit : FUGA_STACK_LIMIT;
+}
 
 void FugaRoot_init(
     void *self
@@ -66,6 +89,9 @@ void FugaRoot_init(
 
     FUGA->Path  = Fuga_clone(FUGA->Object);
     FUGA->Thunk = Fuga_clone(FUGA->Object);
+    FUGA->Range = Fuga_clone(FUGA->Object);
+    FUGA->Iter  = Fuga_clone(FUGA->Object);
+    FUGA->Tail  = Fuga_clone(FUGA->Object);
 
     FUGA->Exception         = Fuga_clone(FUGA->Object);
     FUGA->SlotError         = Fuga_clone(FUGA->Exception);
@@ -75,8 +101,17 @@ void FugaRoot_init(
     FUGA->SyntaxError       = Fuga_clone(FUGA->Exception);
     FUGA->SyntaxUnfinished  = Fuga_clone(FUGA->SyntaxError);
     FUGA->MatchError        = Fuga_clone(FUGA->Exception);
+    FUGA->NoMatch           = Fuga_clone(FUGA->MatchError);
+    FUGA->RecursionError    = Fuga_clone(FUGA->Exception);
+    FUGA->Break             = Fuga_clone(FUGA->Exception);
+    FUGA->Continue          = Fuga_clone(FUGA->Exception);
+    FUGA->Return            = Fuga_clone(FUGA->Exception);
+    FUGA->depthLimit        = FUGA_DEPTH_LIMIT;
+    FUGA->stackLimit        = Fuga_stackLimit(FUGA_PLATFORM_STACK_SIZE);
+    FUGA->jit               = FUGA_PLATFORM_JIT && !FUGA_PLATFORM_NOJIT;
 
     FUGA->symbols = FugaSymbols_new(self);
+    FUGA->strings = FugaString_consts(self);
 
     FugaPrelude_init(FUGA->Prelude);
     FugaInt_init(FUGA->Prelude);
@@ -143,7 +178,9 @@ void* Fuga_cloneM(void* self, void* args) {
     FUGA_NEED(args);
     void* result = Fuga_clone(self);
     FUGA_CHECK(result);
-    FUGA_HEADER(result)->slots = FUGA_HEADER(args)->slots;
+    if (FUGA_HEADER(args)->slots)
+        FugaSlots_share_(FUGA_HEADER(result)->slots,
+                         FUGA_HEADER(args)->slots);
     return result;
 }
 
@@ -168,6 +205,7 @@ void Fuga_initObject(void* self) {
     Fuga_setS(FUGA->Object, "append!", FUGA_METHOD_1(Fuga_append_));
     Fuga_setS(FUGA->Object, "extend!", FUGA_METHOD_1(Fuga_extend_));
     Fuga_setS(FUGA->Object, "update!", FUGA_METHOD_1(Fuga_update_));
+    Fuga_setS(FUGA->Object, "reserve!", FUGA_METHOD(Fuga_reserveM));
     Fuga_setS(FUGA->Object, "copy",    FUGA_METHOD_0(Fuga_copy));
 
     Fuga_setS(FUGA->Object, "eval",   FUGA_METHOD_2(Fuga_eval));
@@ -203,8 +241,67 @@ void* Fuga_raiseM(void* self, void* args) {
     return Fuga_raise(exception);
 }
 
+// A SlotError raised by a failed lookup keeps what its msg is made of,
+// and only makes it when it's asked for: most of them are caught, and
+// never asked.
+typedef struct {
+    const char* where;
+    void* name;
+} FugaSlotError;
+
+const FugaType FugaSlotError_type = {
+    .name = "SlotError"
+};
+
+static void FugaSlotError_mark(void* _self)
+{
+    FugaSlotError* self = _self;
+    Fuga_mark_(self, self->name);
+}
+
+static void* Fuga_slotError(void* self, const char* where, void* name)
+{
+    ALWAYS(self); ALWAYS(where); ALWAYS(name);
+    FugaSlotError* error = Fuga_clone_(FUGA->SlotError, sizeof *error);
+    Fuga_type_(error, &FugaSlotError_type);
+    Fuga_onMark_(error, FugaSlotError_mark);
+    error->where = where;
+    error->name  = name;
+    return Fuga_raise(error);
+}
+
+// SlotError msg: make the msg of a SlotError from a lookup, and keep it.
+static void* Fuga_slotErrorMsg(void* _self)
+{
+    FugaSlotError* self = _self;
+    FUGA_NEED(self);
+    if (!Fuga_hasType_(self, &FugaSlotError_type))
+        return Fuga_slotError(self, "get", FUGA_SYMBOL("msg"));
+    void* name = Fuga_isSymbol(self->name) ? FugaSymbol_toString(self->name)
+                                           : Fuga_str(self->name);
+    FUGA_CHECK(name);
+    FugaString* msg = FUGA_STRING(self->where);
+    msg = FugaString_cat_(msg, FugaString_const(self, ": no slot named '"));
+    msg = FugaString_cat_(msg, name);
+    msg = FugaString_cat_(msg, FugaString_const(self, "'"));
+    FUGA_CHECK(Fuga_setS(self, "msg", msg));
+    return msg;
+}
+
+// SlotError str: show the msg, as if it had been there all along.
+static void* Fuga_slotErrorStr(void* self)
+{
+    FUGA_NEED(self);
+    if (Fuga_hasType_(self, &FugaSlotError_type)
+            && !FugaSlots_hasBySymbol(Fuga_slots(self), FUGA_SYMBOL("msg")))
+        FUGA_CHECK(Fuga_slotErrorMsg(self));
+    return Fuga_strSlots(self);
+}
+
 void Fuga_initException(void* self) {
     Fuga_setS(FUGA->Exception, "raise", FUGA_METHOD(Fuga_raiseM));
+    Fuga_setS(FUGA->SlotError, "msg",   FUGA_METHOD_0(Fuga_slotErrorMsg));
+    Fuga_setS(FUGA->SlotError, "str",   FUGA_METHOD_STR(Fuga_slotErrorStr));
 
     Fuga_setS(FUGA->Exception,   "_name", FUGA_STRING("Exception"));
     Fuga_setS(FUGA->TypeError,   "_name", FUGA_STRING("TypeError"));
@@ -214,14 +311,28 @@ void Fuga_initException(void* self) {
     Fuga_setS(FUGA->SyntaxUnfinished, "_name",
         FUGA_STRING("SyntaxUnfinished"));
     Fuga_setS(FUGA->MatchError, "_name", FUGA_STRING("MatchError"));
+    Fuga_setS(FUGA->NoMatch,    "msg",   FUGA_STRING("no match"));
     Fuga_setS(FUGA->SlotError,  "_name", FUGA_STRING("SlotError"));
+    Fuga_setS(FUGA->RecursionError, "_name",
+        FUGA_STRING("RecursionError"));
+    Fuga_setS(FUGA->Break,      "_name", FUGA_STRING("Break"));
+    Fuga_setS(FUGA->Continue,   "_name", FUGA_STRING("Continue"));
+    Fuga_setS(FUGA->Break,      "msg",
+        FUGA_STRING("break outside of a loop"));
+    Fuga_setS(FUGA->Continue,   "msg",
+        FUGA_STRING("continue outside of a loop"));
+    Fuga_setS(FUGA->Return,     "_name", FUGA_STRING("Return"));
+    Fuga_setS(FUGA->Return,     "msg",
+        FUGA_STRING("return outside of its method"));
 }
 
 #ifdef TESTING
 TESTS(Fuga_init) {
     void* self = Fuga_init();
-    for (size_t i = 0; i < sizeof *FUGA / sizeof(size_t); i++)
+    for (size_t i = 0; i < offsetof(FugaRoot, tail) / sizeof(size_t); i++)
         TEST(((size_t*)FUGA)[i]);
+    TEST(!FUGA->tail.method && !FUGA->tail.code);
+    TEST(!FUGA->unwind.value);
     
     FugaHeader* header = FUGA_HEADER(FUGA);
     TEST(FUGA->roots.next == (void*)header);
@@ -234,14 +345,29 @@ TESTS(Fuga_init) {
 #endif
 
 
+/**
+ * Go from an object to the FugaSlots embedded in front of it, and back.
+ */
+#define FUGA_EMBEDDED(header)   \
+    ((FugaHeader*)((char*)(header) - FugaSlots_embedSize))
+#define FUGA_EMBEDDER(header)   \
+    ((FugaHeader*)((char*)(header) + FugaSlots_embedSize))
+
 void FugaHeader_free(
     FugaHeader* self
 ) {
     ALWAYS(self);
     NEVER(Fuga_isRaised(self));
+    NEVER(self->gc.embedded);
     if (self->gc.free)
         self->gc.free(FUGA_DATA(self));
-    free(self);
+    if (self->gc.embedsSlots) {
+        FugaHeader* embedded = FUGA_EMBEDDED(self);
+        embedded->gc.free(FUGA_DATA(embedded));
+        free(embedded);
+    } else {
+        free(self);
+    }
 }
 
 void FugaHeader_mark(
@@ -255,6 +381,8 @@ void FugaHeader_mark(
     Fuga_mark_(FUGA_DATA(header), header->proto);
     if (header->gc.mark)
         header->gc.mark(FUGA_DATA(header));
+    if (header->gc.embedsSlots)
+        FugaHeader_mark(FUGA_EMBEDDED(header));
 }
 
 /**
@@ -279,31 +407,52 @@ void Fuga_quit(void* self)
     FugaHeader_free(FUGA_HEADER(self));
 }
 
-/**
- * Clone.
- */
-void* Fuga_clone(
-    void* proto
-) {
-    return Fuga_clone_(proto, 0);
-}
-
-void* Fuga_clone_(
+static void* Fuga_new_(
     void* proto,
-    size_t size
+    size_t size,
+    bool embedSlots
 ) {
     ALWAYS(proto);
     FUGA_CHECK(proto);
-    FugaHeader* header  = calloc(sizeof(FugaHeader)+size, 1);
+    size_t embed  = embedSlots ? FugaSlots_embedSize : 0;
+    char*  block  = calloc(embed+sizeof(FugaHeader)+size, 1);
+    FugaHeader* header  = (FugaHeader*)(block + embed);
     void* self    = FUGA_DATA(header);
     header->root  = FUGA_HEADER(proto)->root;
     header->proto = proto;
     header->gc.pass = FUGA_HEADER(header->root)->gc.pass;
     FugaGCList_init(&header->gc.list);
     FugaGCList_push_(&FUGA->grey, &header->gc.list);
+    if (embedSlots) {
+        header->gc.embedsSlots = true;
+        header->slots = FugaSlots_embed(self, block);
+    }
     return self;
 }
 
+void* Fuga_clone_(
+    void* proto,
+    size_t size
+) {
+    return Fuga_new_(proto, size, false);
+}
+
+void* Fuga_cloneInline_(
+    void* proto,
+    size_t size
+) {
+    return Fuga_new_(proto, size, true);
+}
+
+/**
+ * Clone.
+ */
+void* Fuga_clone(
+    void* proto
+) {
+    return Fuga_new_(proto, 0, true);
+}
+
 const FugaType* Fuga_type(void* self) {
     ALWAYS(self);
     NEVER(Fuga_isRaised(self));
@@ -316,6 +465,18 @@ void Fuga_type_(void* self, const FugaType* type) {
     FUGA_HEADER(self)->type = type;
 }
 
+void Fuga_freeze(void* self) {
+    ALWAYS(self);
+    NEVER(Fuga_isRaised(self));
+    FUGA_HEADER(self)->gc.frozen = true;
+}
+
+bool Fuga_isFrozen(void* self) {
+    ALWAYS(self);
+    NEVER(Fuga_isRaised(self));
+    return FUGA_HEADER(self)->gc.frozen;
+}
+
 /**
 *** ## Garbage Collection
 **/
@@ -368,6 +529,8 @@ void Fuga_mark_(
     NEVER(Fuga_isRaised(child));
     unsigned pass = FUGA_HEADER(FUGA)->gc.pass;
     FugaHeader* header = FUGA_HEADER(child);
+    if (header->gc.embedded)
+        header = FUGA_EMBEDDER(header);
     if (header->gc.pass != pass) {
         header->gc.pass = pass;
         if (header->gc.root)
@@ -377,6 +540,16 @@ void Fuga_mark_(
     }
 }
 
+bool Fuga_isMarked(
+    void* self
+) {
+    ALWAYS(self);
+    NEVER(Fuga_isRaised(self));
+    FugaHeader* header = FUGA_HEADER(self);
+    if (header->gc.embedded)
+        header = FUGA_EMBEDDER(header);
+    return header->gc.pass == FUGA_HEADER(FUGA)->gc.pass;
+}
 
 void Fuga_collect(
     void* self
@@ -399,6 +572,7 @@ void Fuga_collect(
         FugaGCList_push_(&FUGA->black, iter);
         FugaHeader_mark(header);
     }
+    FugaMemo_sweep(self);
     while (!FugaGCList_empty(&FUGA->white)) {
         iter = FugaGCList_pop(&FUGA->white);
         header = (FugaHeader*)iter;
@@ -406,6 +580,30 @@ void Fuga_collect(
     }
 }
 
+#ifdef TESTING
+TESTS(Fuga_collect) {
+    void* self = Fuga_init();
+    void* a = Fuga_clone(FUGA->Object);
+    void* b = Fuga_clone(FUGA->Object);
+    void* c = Fuga_clone(FUGA->Object);
+    Fuga_root(a);
+    TEST(!Fuga_isRaised(Fuga_setS(a, "b", b)));
+    TEST(!Fuga_isRaised(Fuga_setS(b, "x", FUGA_INT(10))));
+    TEST(!Fuga_isRaised(Fuga_setS(c, "y", FUGA_INT(20))));
+    // Holding on to an object's slots keeps the object alive, as they
+    // share an allocation.
+    TEST(!Fuga_isRaised(Fuga_setS(a, "c", Fuga_slots(c))));
+    TEST(!Fuga_isRaised(Fuga_setS(Fuga_clone(FUGA->Object), "z", a)));
+
+    Fuga_collect(self);
+    TEST(FugaInt_is_(Fuga_getS(b, "x"), 10));
+    TEST(FugaInt_is_(Fuga_getS(Fuga_getS(a, "c"), "y"), 20));
+    TEST(FugaInt_is_(Fuga_getS(c, "y"), 20));
+
+    Fuga_quit(self);
+}
+#endif
+
 /**
  * Was an exception raised?
  */
@@ -477,6 +675,115 @@ TESTS(Fuga_catch) {
 }
 #endif
 
+/**
+ * Is a caught exception the marker of a non-local exit?
+ */
+bool Fuga_isUnwind(
+    void* self
+) {
+    ALWAYS(self);
+    return self == FUGA->Break || self == FUGA->Continue
+        || self == FUGA->Return;
+}
+
+#ifdef TESTING
+void* Fuga_isUnwind_test(void* self, void* result) {
+    FUGA_TRY(result) {
+        FUGA_CATCH(FUGA->Exception)
+            return FUGA->nil;
+        FUGA_RERAISE;
+    }
+    return result;
+}
+
+TESTS(Fuga_isUnwind) {
+    void* self = Fuga_init();
+    TEST( Fuga_isUnwind(FUGA->Break));
+    TEST( Fuga_isUnwind(FUGA->Continue));
+    TEST( Fuga_isUnwind(FUGA->Return));
+    TEST(!Fuga_isUnwind(FUGA->Exception));
+    TEST(!Fuga_isUnwind(Fuga_clone(FUGA->Return)));
+
+    void* error = Fuga_raise(FUGA->TypeError);
+    void* exit  = Fuga_raise(FUGA->Return);
+    TEST(Fuga_isUnwind_test(self, error) == FUGA->nil);
+    TEST(Fuga_isUnwind_test(self, exit)  == exit);
+    Fuga_quit(self);
+}
+#endif
+
+/**
+ * Count one more level of nesting, checking both the count and how much
+ * C stack it's used since the outermost level.
+ */
+void* Fuga_enter(void* self)
+{
+    ALWAYS(self);
+    uintptr_t here = (uintptr_t)&self;
+    if (!FUGA->depth)
+        FUGA->stackBase = here;
+    uintptr_t used = here < FUGA->stackBase ? FUGA->stackBase - here
+                                            : here - FUGA->stackBase;
+    if (FUGA->depth >= FUGA->depthLimit || used >= FUGA->stackLimit)
+        FUGA_RAISE(FUGA->RecursionError,
+            "maximum recursion depth exceeded"
+        );
+    FUGA->depth++;
+    return NULL;
+}
+
+#ifdef TESTING
+void* Fuga_enter_test(void* self, size_t levels) {
+    if (!levels)
+        return FUGA->nil;
+    FUGA_ENTER;
+    void* result = Fuga_enter_test(self, levels-1);
+    FUGA_LEAVE;
+    return result;
+}
+
+TESTS(Fuga_enter) {
+    void* self = Fuga_init();
+    TEST(FUGA->depth == 0);
+    TEST(FUGA->depthLimit == FUGA_DEPTH_LIMIT);
+
+    FUGA->depthLimit = 10;
+    TEST(!Fuga_isRaised(Fuga_enter_test(self, 10)));
+    TEST(FUGA->depth == 0);
+    TEST(Fuga_isa_(Fuga_catch(Fuga_enter_test(self, 11)),
+                   FUGA->RecursionError));
+    TEST(FUGA->depth == 0);
+
+    FUGA->depthLimit = FUGA_DEPTH_LIMIT;
+    FUGA->stackLimit = 0;
+    TEST(Fuga_isRaised(Fuga_enter_test(self, 1)));
+    TEST(FUGA->depth == 0);
+
+    // The default follows the stack's size, up to FUGA_STACK_LIMIT.
+    TEST(Fuga_stackLimit(2 << 20) == (3 << 19));
+    TEST(Fuga_stackLimit(0) == FUGA_STACK_LIMIT);
+    TEST(Fuga_stackLimit(1 << 30) == FUGA_STACK_LIMIT);
+
+    // Fuga methods that recurse too deeply for the stack stop, too.
+    FUGA->depthLimit = 100 * FUGA_DEPTH_LIMIT;
+    FUGA->stackLimit = 64 << 10;
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "deep(n) { if(n == 0, 0, 1 + deep(n - 1)) }\n"
+        "deep(1000000)\n"
+    );
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "_this", scope)));
+    TEST(Fuga_isa_(Fuga_catch(FugaCode_evalIn(code, scope)),
+                   FUGA->RecursionError));
+    TEST(FUGA->depth == 0);
+
+    Fuga_quit(self);
+}
+#endif
+
 /**
  * Are two objects the same (taking into account thunks).
  */
@@ -496,9 +803,11 @@ bool Fuga_isa_(void* self, void* other)
     ALWAYS(self); ALWAYS(other);
     self  = Fuga_need(self);  if (Fuga_isRaised(self))  return false;
     other = Fuga_need(other); if (Fuga_isRaised(other)) return false;
-    void* proto = FUGA_HEADER(self)->proto;
-    if (!proto) return false;
-    return Fuga_is_(proto, other) || Fuga_isa_(proto, other);
+    for (void* proto = FUGA_HEADER(self)->proto; proto;
+               proto = FUGA_HEADER(proto)->proto)
+        if (proto == other)
+            return true;
+    return false;
 }
 
 bool Fuga_isTrue(void* self) {
@@ -654,11 +963,11 @@ void* Fuga_dir(
 
 
 /**
- * Get the slot associated with a given name. Return NULL if no such
- * slot. Do not pass raised exceptions to this function. name must 
- * be a FugaInt or a FugaSymbol.
+ * Get the slot associated with a given name. The slot's value is NULL if
+ * there is no such slot. Do not pass raised exceptions to this function.
+ * name must be a FugaInt or a FugaSymbol.
  */
-FugaSlot* Fuga_getSlot_(void* self, void* name) 
+FugaSlot Fuga_getSlot_(void* self, void* name) 
 {
     ALWAYS(self); ALWAYS(name);
     ALWAYS(!Fuga_isRaised(self));
@@ -672,7 +981,22 @@ FugaSlot* Fuga_getSlot_(void* self, void* name)
             return FugaSlots_getBySymbol(FUGA_HEADER(self)->slots, name);
         }
     }
-    return NULL;
+    FugaSlot slot = {.value = NULL, .name = NULL, .doc = NULL};
+    return slot;
+}
+
+/**
+ * Get just the value of the slot with a given name, or NULL, like
+ * Fuga_getSlot_ but without fetching its doc.
+ */
+static void* Fuga_getValue_(void* self, void* name)
+{
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    if (!slots)
+        return NULL;
+    if (Fuga_isInt(name))
+        return FugaSlots_valueByIndex(slots, FugaInt_value(name));
+    return FugaSlots_valueBySymbol(slots, name);
 }
 
 /**
@@ -695,8 +1019,8 @@ void* Fuga_hasName(void* self, void* name)
             "hasName_: index >= numSlots"
         );
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot->name)
+    FugaSlot slot = Fuga_getSlot_(self, name);
+    if (slot.name)
         return FUGA->True;
     else
         return FUGA->False;
@@ -719,8 +1043,8 @@ void* Fuga_hasDoc(void* self, void* name)
             );
     }
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot && slot->doc) {
+    FugaSlot slot = Fuga_getSlot_(self, name);
+    if (slot.doc) {
         return FUGA->True;
     } else if (FUGA_HEADER(self)->proto) {
         if (Fuga_isInt(name)) {
@@ -755,9 +1079,9 @@ void* Fuga_getName(void* self, void* name)
             "getName_: index >= numSlots"
         );
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot->name) {
-        return slot->name;
+    FugaSlot slot = Fuga_getSlot_(self, name);
+    if (slot.name) {
+        return slot.name;
     } else {
         FUGA_RAISE(FUGA->SlotError,
             "getName_: slot has no name"
@@ -782,9 +1106,9 @@ void* Fuga_getDoc(void* self, void* name)
             );
     }
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot && slot->doc)
-        return slot->doc;
+    FugaSlot slot = Fuga_getSlot_(self, name);
+    if (slot.doc)
+        return slot.doc;
     if (FUGA_HEADER(self)->proto) {
         if (Fuga_isInt(name)) {
             FUGA_IF(Fuga_hasName(self, name))
@@ -803,6 +1127,8 @@ void* Fuga_setDoc(void* self, void* name, void* value)
 {
     ALWAYS(self); ALWAYS(name);
     FUGA_NEED(self); FUGA_NEED(name);
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "setDoc: can't change a literal");
     name = Fuga_toName(name, self);
     FUGA_NEED(name);
     if (Fuga_isInt(name)) {
@@ -816,9 +1142,12 @@ void* Fuga_setDoc(void* self, void* name, void* value)
             );
     }
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot)
-        slot->doc = value;
+    FugaSlot slot = Fuga_getSlot_(self, name);
+    if (slot.value && Fuga_isInt(name))
+        FugaSlots_setDocByIndex(FUGA_HEADER(self)->slots,
+                                FugaInt_value(name), value);
+    else if (slot.value)
+        FugaSlots_setDocBySymbol(FUGA_HEADER(self)->slots, name, value);
     else if (!Fuga_isInt(name) && Fuga_proto(self))
         return Fuga_setDoc(Fuga_proto(self), name, value);
     else 
@@ -1028,20 +1357,11 @@ void* Fuga_getRaw(void* self, void* name)
     name = Fuga_toName(name, self);
     FUGA_CHECK(name);
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot)
-        return slot->value;
+    void* value = Fuga_getValue_(self, name);
+    if (value)
+        return value;
 
-    // raise SlotError
-    FugaString *msg = FUGA_STRING("getRaw: no slot named '");
-    if (Fuga_isSymbol(name))
-        msg = FugaString_cat_(msg, FugaSymbol_toString(name));
-    else
-        msg = FugaString_cat_(msg, Fuga_str(name));
-    msg = FugaString_cat_(msg, FUGA_STRING("'"));
-    void* error = Fuga_clone(FUGA->SlotError);
-    FUGA_CHECK(Fuga_setS(error, "msg", msg));
-    return Fuga_raise(error);
+    return Fuga_slotError(self, "getRaw", name);
 }
 
 #ifdef TESTING
@@ -1120,23 +1440,15 @@ void* Fuga_get(void* self, void* name)
     name = Fuga_toName(name, self);
     FUGA_CHECK(name);
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot)
-        return slot->value;
-
-    if (FUGA_HEADER(self)->proto && Fuga_isSymbol(name))
-        return Fuga_get(FUGA_HEADER(self)->proto, name);
+    for (void* obj = self; obj; obj = FUGA_HEADER(obj)->proto) {
+        void* value = Fuga_getValue_(obj, name);
+        if (value)
+            return value;
+        if (!Fuga_isSymbol(name))
+            break;
+    }
 
-    // raise SlotError
-    FugaString *msg = FUGA_STRING("get: no slot named '");
-    if (Fuga_isSymbol(name))
-        msg = FugaString_cat_(msg, FugaSymbol_toString(name));
-    else
-        msg = FugaString_cat_(msg, Fuga_str(name));
-    msg = FugaString_cat_(msg, FUGA_STRING("'"));
-    void* error = Fuga_clone(FUGA->SlotError);
-    FUGA_CHECK(Fuga_setS(error, "msg", msg));
-    return Fuga_raise(error);
+    return Fuga_slotError(self, "get", name);
 }
 
 #ifdef TESTING
@@ -1203,6 +1515,15 @@ TESTS(Fuga_get) {
     TEST(prim == Fuga_get(obj, Fuga_lazy_(FUGA_INT(0), self)));
     TEST(a == Fuga_get(a, Fuga_lazy_(FUGA_SYMBOL("a"), self)));
 
+
+    // The msg of a SlotError is only made when it's asked for.
+    void* error = Fuga_catch(Fuga_get(a, FUGA_SYMBOL("c")));
+    TEST(Fuga_isa_(error, FUGA->SlotError));
+    TEST(!Fuga_length(error));
+    void* msg = Fuga_sendN(error, FUGA_SYMBOL("msg"), 0, NULL);
+    TEST(Fuga_isString(msg) && FugaString_is_(msg, "get: no slot named 'c'"));
+    TEST(Fuga_getS(error, "msg") == msg);
+
     Fuga_quit(self);
 }
 #endif
@@ -1211,6 +1532,8 @@ void* Fuga_append_(void* self, void* value)
 {
     ALWAYS(self); ALWAYS(value);
     FUGA_NEED(self);
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "append: can't change a literal");
     FUGA_CHECK(value);
     FugaSlots* slots = Fuga_slots(self);
     FUGA_CHECK(slots);
@@ -1232,6 +1555,8 @@ void* Fuga_set(void* self, void* name, void* value)
 {
     ALWAYS(self); ALWAYS(value);
     FUGA_NEED(self);
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "set: can't change a literal");
     FUGA_CHECK(value);
     FugaSlots* slots = Fuga_slots(self);
     FUGA_CHECK(slots);
@@ -1290,6 +1615,12 @@ TESTS(Fuga_set) {
     TEST( Fuga_isRaised (Fuga_set(a, Fuga_raise(FUGA_INT(0)), a)) );
     TEST( Fuga_isRaised (Fuga_set(a, FUGA_INT(0), Fuga_raise(a))) );
 
+    Fuga_freeze(a);
+    TEST( Fuga_isRaised (Fuga_set(a, FUGA_SYMBOL("c"), a)) );
+    TEST( Fuga_isRaised (Fuga_setDoc(a, FUGA_SYMBOL("a"),
+                                     FUGA_STRING("doc"))) );
+    TEST( Fuga_isFalse  (Fuga_hasDocS(a, "a")) );
+
     Fuga_quit(self);
 }
 #endif
@@ -1313,12 +1644,16 @@ void* Fuga_del(void* self, void* name)
 {
     ALWAYS(self); ALWAYS(name);
     FUGA_NEED(self);
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "del: can't change a literal");
     name = Fuga_toName(name, self);
     FUGA_CHECK(name);
 
-    FugaSlot* slot = Fuga_getSlot_(self, name);
-    if (slot)
-        FugaSlots_delByIndex(FUGA_HEADER(self)->slots, slot->index);
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    if (slots && Fuga_isInt(name))
+        FugaSlots_delByIndex(slots, FugaInt_value(name));
+    else if (slots)
+        FugaSlots_delBySymbol(slots, name);
     return FUGA->nil;
 }
 
@@ -1352,7 +1687,10 @@ void* Fuga_hasDocI    (void* self, long index)
     { FUGA_CHECK(self);
       return Fuga_hasDoc     (self, FUGA_INT(index));   }
 void* Fuga_getI       (void* self, long index)
-    { FUGA_CHECK(self);
+    { FUGA_NEED(self);
+      FugaSlots* slots = FUGA_HEADER(self)->slots;
+      if (slots && index >= 0 && index < FugaSlots_length(slots))
+          return FugaSlots_getByIndex(slots, index).value;
       return Fuga_get        (self, FUGA_INT(index));   }
 void* Fuga_getNameI   (void* self, long index)
     { FUGA_CHECK(self);
@@ -1370,41 +1708,118 @@ void* Fuga_delI       (void* self, long index)
     { FUGA_CHECK(self);
       return Fuga_del        (self, FUGA_INT(index));   }
 
+/**
+ * Give the slots of self that came from other's named slots, starting at
+ * index start, the docs other inherits for them from its proto.
+ */
+static void* Fuga_inheritDocs_(
+    void* self,
+    void* other,
+    long start,
+    bool byName
+) {
+    void* proto = Fuga_proto(other);
+    FugaSlots* slots = FUGA_HEADER(other)->slots;
+    long length = Fuga_length(other);
+    for (long i = 0; proto && i < length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(slots, i);
+        if (slot.doc || !slot.name)
+            continue;
+        FUGA_IF(Fuga_hasDoc(proto, slot.name)) {
+            void* doc = Fuga_getDoc(proto, slot.name);
+            if (byName)
+                FUGA_CHECK(Fuga_setDoc(self, slot.name, doc));
+            else
+                FUGA_CHECK(Fuga_setDocI(self, start + i, doc));
+        }
+    }
+    return FUGA->nil;
+}
+
 void* Fuga_extend_(
     void* self,
     void* other
 ) {
     ALWAYS(self);       ALWAYS(other);
     FUGA_NEED(self);    FUGA_NEED(other);
-    FUGA_FOR(i, slot, other) {
-        FUGA_CHECK(Fuga_append_(self, slot));
-        FUGA_IF(Fuga_hasDocI(other, i)) {
-            void* doc = Fuga_getDocI(other, i);
-            FUGA_CHECK(Fuga_setDocI(self, -1, doc));
-        }
-    }
+    FugaSlots* slots = FUGA_HEADER(other)->slots;
+    if (!slots)
+        return FUGA->nil;
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "extend: can't change a literal");
+    long start = Fuga_length(self);
+    FugaSlots_extend_(Fuga_slots(self), slots);
+    return Fuga_inheritDocs_(self, other, start, false);
+}
+
+/**
+ * Make room for more slots, so that adding them doesn't reallocate.
+ */
+void* Fuga_reserve_(
+    void* self,
+    long unnamed,
+    long named
+) {
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "reserve: can't change a literal");
+    if (unnamed < 0 || named < 0)
+        FUGA_RAISE(FUGA->ValueError, "reserve: expected a count >= 0");
+    FugaSlots_reserve(Fuga_slots(self), unnamed, named);
     return FUGA->nil;
 }
 
+void* Fuga_reserveM(
+    void* self,
+    void* args
+) {
+    FUGA_NEED(self);
+    FUGA_NEED(args);
+    long length = Fuga_length(args);
+    if (length < 1 || length > 2)
+        FUGA_RAISE(FUGA->TypeError, "reserve: expected 1 or 2 arguments");
+    void* unnamed = Fuga_getI(args, 0);
+    void* named   = length > 1 ? Fuga_getI(args, 1) : FUGA_INT(0);
+    FUGA_NEED(unnamed);
+    FUGA_NEED(named);
+    if (!Fuga_isInt(unnamed) || !Fuga_isInt(named))
+        FUGA_RAISE(FUGA->TypeError, "reserve: expected primitive ints");
+    return Fuga_reserve_(self, FugaInt_value(unnamed), FugaInt_value(named));
+}
+
 void* Fuga_update_(
     void* self,
     void* other
 ) {
     ALWAYS(self);       ALWAYS(other);
     FUGA_NEED(self);    FUGA_NEED(other);
-    FUGA_FOR(i, slot, other) {
-        FUGA_IF(Fuga_hasNameI(other, i)) {
-            void* name = Fuga_getNameI(other, i);
-            FUGA_CHECK(Fuga_set(self, name, slot));
-            FUGA_IF(Fuga_hasDocI(other, i)) {
-                void* doc = Fuga_getDocI(other, i);
-                FUGA_CHECK(Fuga_setDoc(self, name, doc));
-            }
-        }
-    }
-    return FUGA->nil;
+
+    FugaSlots* slots = FUGA_HEADER(other)->slots;
+    if (!slots)
+        return FUGA->nil;
+    if (Fuga_isFrozen(self))
+        FUGA_RAISE(FUGA->TypeError, "update: can't change a literal");
+
+    // If self has no slots of its own and every slot in other is named,
+    // the result is other's slot table, so share it.
+    long length = Fuga_length(other);
+    long i = 0;
+    if (!Fuga_length(self))
+        while (i < length && FugaSlots_getByIndex(slots, i).name)
+            i++;
+    if (length && i == length)
+        FugaSlots_share_(Fuga_slots(self), slots);
+    else
+        FugaSlots_update_(Fuga_slots(self), slots);
+    return Fuga_inheritDocs_(self, other, 0, true);
 }
 
+/**
+ * Copy an object's slots into a fresh clone of its proto. The slot
+ * table itself is shared copy-on-write, so this is O(1) until either
+ * object is modified.
+ */
 void* Fuga_copy(
     void* self
 ) {
@@ -1414,21 +1829,45 @@ void* Fuga_copy(
         result = Fuga_clone(Fuga_proto(self));
     else
         result = Fuga_clone(FUGA->Object);
-    FUGA_FOR(i, slot, self) {
-        FUGA_IF(Fuga_hasNameI(self, i)) {
-            void* name = Fuga_getNameI(self, i);
-            FUGA_CHECK(Fuga_set(result, name, slot));
-        } else {
-            FUGA_CHECK(Fuga_append_(result, slot));
-        }
-      { FUGA_IF(Fuga_hasDocI(self, i)) {
-            void* doc = Fuga_getDocI(self, i);
-            FUGA_CHECK(Fuga_setDocI(result, -1, doc));
-        } }
-    }
+    if (FUGA_HEADER(self)->slots)
+        FugaSlots_share_(FUGA_HEADER(result)->slots,
+                         FUGA_HEADER(self)->slots);
     return result;
 }
 
+#ifdef TESTING
+TESTS(Fuga_copy) {
+    void* self = Fuga_init();
+    void* a = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_setS(a, "x", FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(a, FUGA_INT(2))));
+    TEST(!Fuga_isRaised(Fuga_setDocS(a, "x", FUGA_STRING("doc"))));
+
+    void* b = Fuga_copy(a);
+    TEST(Fuga_proto(b) == FUGA->Object);
+    TEST(Fuga_hasLength_(b, 2));
+    TEST(FugaInt_is_(Fuga_getS(b, "x"), 1));
+    TEST(FugaInt_is_(Fuga_getI(b, 1), 2));
+    TEST(Fuga_isTrue(Fuga_hasDocS(b, "x")));
+
+    TEST(!Fuga_isRaised(Fuga_setS(b, "x", FUGA_INT(3))));
+    TEST(!Fuga_isRaised(Fuga_append_(a, FUGA_INT(4))));
+    TEST(FugaInt_is_(Fuga_getS(a, "x"), 1));
+    TEST(FugaInt_is_(Fuga_getS(b, "x"), 3));
+    TEST(Fuga_hasLength_(a, 3));
+    TEST(Fuga_hasLength_(b, 2));
+
+    void* c = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_update_(c, a)));
+    TEST(Fuga_hasLength_(c, 1));
+    TEST(!Fuga_isRaised(Fuga_update_(c, b)));
+    TEST(Fuga_hasLength_(c, 1));
+    TEST(FugaInt_is_(Fuga_getS(c, "x"), 3));
+    TEST(FugaInt_is_(Fuga_getS(b, "x"), 3));
+
+    Fuga_quit(self);
+}
+#endif
 
 /**
  * Call / resolve a method.
@@ -1464,6 +1903,56 @@ void* Fuga_send(void* self, void* name, void* args)
     return Fuga_call(method, self, args);
 }
 
+/**
+ * Send, with the args in an array. No args object is made unless the
+ * method needs one (see FugaMethod_callN).
+ */
+void* Fuga_sendN(void* self, void* name, size_t argc, void** argv)
+{
+    ALWAYS(self);    ALWAYS(name);
+    FUGA_NEED(self); FUGA_NEED(name);
+
+    void* method = Fuga_get(self, name);
+    FUGA_NEED(method);
+    if (Fuga_isMethod(method))
+        return FugaMethod_callN(method, self, argc, argv);
+    if (argc)
+        FUGA_RAISE(FUGA->TypeError,
+            "attempt to call a non-method with arguments"
+        );
+    return method;
+}
+
+#ifdef TESTING
+TESTS(Fuga_sendN) {
+    void* self = Fuga_init();
+    void* argv[2] = {FUGA_INT(2), FUGA_INT(3)};
+
+    // strict methods get argv as it is...
+    TEST(FugaInt_is_(Fuga_sendN(FUGA_INT(1), FUGA_SYMBOL("+"), 1, argv), 3));
+    TEST(FugaInt_is_(Fuga_sendN(FUGA_INT(1), FUGA_SYMBOL("-"), 0, argv), -1));
+    TEST(Fuga_isRaised(Fuga_sendN(FUGA_INT(1), FUGA_SYMBOL("*"), 2, argv)));
+    TEST(Fuga_isString(Fuga_sendN(FUGA_INT(1), FUGA_SYMBOL("str"), 0, NULL)));
+
+    // ... other methods get an args object ...
+    void* scope   = Fuga_clone(FUGA->Prelude);
+    void* formals = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(formals, FUGA_MSG("a"))));
+    TEST(!Fuga_isRaised(Fuga_append_(formals, FUGA_MSG("b"))));
+    void* obj = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_setS(obj, "second",
+        FugaMethod_method(scope, formals, FUGA_MSG("b")))));
+    TEST(FugaInt_is_(Fuga_sendN(obj, FUGA_SYMBOL("second"), 2, argv), 3));
+
+    // ... and other values get no args at all.
+    TEST(!Fuga_isRaised(Fuga_setS(obj, "x", FUGA_INT(4))));
+    TEST(FugaInt_is_(Fuga_sendN(obj, FUGA_SYMBOL("x"), 0, NULL), 4));
+    TEST(Fuga_isRaised(Fuga_sendN(obj, FUGA_SYMBOL("x"), 1, argv)));
+
+    Fuga_quit(self);
+}
+#endif
+
 /**
  * Evaluate an object
  */
@@ -1481,6 +1970,9 @@ void* Fuga_eval(void* self, void* recv, void* scope)
     if (Fuga_isExpr(self))
         return Fuga_evalExpr(self, recv, scope);
 
+    if (FugaCode_isCompiled(self))
+        return FugaCode_evalCompiled(self, recv, scope, false);
+
     return Fuga_evalSlots(self, scope);
 }
 
@@ -1519,66 +2011,47 @@ TESTS(Fuga_eval) {
 }
 #endif
 
+/**
+ * Evaluate each slot of a block. See code.c.
+ */
 void* Fuga_evalSlots(void* self, void* scope)
 {
-    ALWAYS(self); ALWAYS(scope);
-    FUGA_NEED(self); FUGA_NEED(scope);
-    void* escope = Fuga_clone(scope);
-    void* result = Fuga_clone(FUGA->Object);
-    FUGA_CHECK(Fuga_setS(escope, "_this", result));
-    FUGA_FOR(i, slot, self) { 
-        FUGA_IF(Fuga_hasDocI(self, i)) {
-            void* doc = Fuga_getDocI(self, i);
-            FUGA_CHECK(Fuga_setS(escope, "_doc", doc));
-        } else {
-            FUGA_CHECK(Fuga_delS(escope, "_doc"));
-        }
-        void* value = Fuga_eval(slot, escope, escope);
-        FUGA_CHECK(value);
-        if (!Fuga_isNil(value))
-            FUGA_CHECK(Fuga_append_(result, value));
-    }
-    return result;
+    return FugaCode_evalSlots(self, scope);
 }
 
 void* Fuga_evalIn(void* self, void* scope)
 {
-    ALWAYS(self); ALWAYS(scope);
-    FUGA_NEED(self); FUGA_NEED(scope);
-    void* escope = Fuga_clone(scope);
-    FUGA_CHECK(Fuga_setS(escope, "_this", scope));
-    void* value = FUGA->nil;
-    FUGA_FOR(i, slot, self) {
-        FUGA_IF(Fuga_hasDocI(self, i)) {
-            void* doc = Fuga_getDocI(self, i);
-            FUGA_CHECK(Fuga_setS(escope, "_doc", doc));
-        } else {
-            FUGA_CHECK(Fuga_delS(escope, "_doc"));
-        }
-        FUGA_CHECK(value = Fuga_eval(slot, escope, escope));
-    }
-    return value;
+    return FugaCode_evalIn(self, scope);
+}
+
+#ifdef TESTING
+TESTS(Fuga_evalIn) {
+    void* self = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    void* code = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(code, FUGA_MSG("_doc"))));
+    TEST(!Fuga_isRaised(Fuga_setDocI(code, 0, FUGA_STRING("doc"))));
+
+    // the doc is visible while evaluating its slot, and only then.
+    void* result = Fuga_evalSlots(code, scope);
+    TEST(!Fuga_isRaised(result));
+    TEST(Fuga_hasLength_(result, 1));
+    TEST(FugaString_is_(Fuga_getI(result, 0), "doc"));
+    TEST(FugaString_is_(Fuga_evalIn(code, scope), "doc"));
+    TEST(!Fuga_isRaised(Fuga_append_(code, FUGA_MSG("_doc"))));
+    TEST(Fuga_isRaised(Fuga_evalSlots(code, scope)));
+    TEST(Fuga_isRaised(Fuga_evalIn(code, scope)));
+
+    Fuga_quit(self);
 }
+#endif
 
 void* Fuga_evalExpr(
     void* self,
     void* recv,
     void* scope
 ) {
-    ALWAYS(self); ALWAYS(recv); ALWAYS(scope);
-    FUGA_NEED(self); FUGA_NEED(recv); FUGA_NEED(scope);
-    long length = Fuga_length(self);
-    if (length < 1) {
-        FUGA_RAISE(FUGA->ValueError,
-            "Expr eval: can't evaluate empty expression"
-        );
-    }
-    for (long i = 0; i < length; i++) {
-        void* part = Fuga_get(self, FUGA_INT(i));
-        recv = Fuga_eval(part, recv, scope);
-        FUGA_CHECK(recv);
-    }
-    return recv;
+    return FugaCode_evalExpr(self, recv, scope);
 }
 
 void* Fuga_evalModule(
@@ -1625,8 +2098,7 @@ void* Fuga_str(void* self)
 {
     ALWAYS(self);
     FUGA_NEED(self);
-    void* result = Fuga_send(self, FUGA_SYMBOL("str"),
-                             Fuga_clone(FUGA->Object));
+    void* result = Fuga_sendN(self, FUGA_SYMBOL("str"), 0, NULL);
     FUGA_NEED(result);
     if (!Fuga_isString(result)) {
         FUGA_RAISE(FUGA->TypeError,
@@ -1704,7 +2176,7 @@ void Fuga_printException(void* self)
     ALWAYS(self);
     if (Fuga_isRaised(self))
         self = Fuga_catch(self);
-    void *msg = Fuga_get(self, FUGA_SYMBOL("msg"));
+    void *msg = Fuga_sendN(self, FUGA_SYMBOL("msg"), 0, NULL);
     printf("EXCEPTION:\n\t");
     if (Fuga_isString(msg)) {
         FugaString_print(msg);
@@ -1728,9 +2200,7 @@ void* Fuga_match_(void* self, void* attempt)
 {
     FUGA_NEED(self);
     FUGA_CHECK(attempt);
-    void* arg = Fuga_clone(FUGA->Object);
-    FUGA_CHECK(Fuga_append_(arg, attempt));
-    return Fuga_send(self, FUGA_SYMBOL("match"), arg);
+    return Fuga_sendN(self, FUGA_SYMBOL("match"), 1, &attempt);
 }
 
 void* FugaObject_match_(void* self, void* attempt)
@@ -1749,7 +2219,7 @@ void* FugaObject_match_(void* self, void* attempt)
     FUGA_NEED(attempt);
     // FIXME: allow varargs
     if (!Fuga_hasLength_(self, Fuga_length(attempt)))
-        FUGA_RAISE(FUGA->MatchError, "different lengths");
+        FUGA_NO_MATCH;
     void* result = Fuga_clone(FUGA->Object);
     FUGA_FOR(i, slot, self) {
         void* resultSlot = Fuga_match_(slot, Fuga_getI(attempt, i));
@@ -1759,3 +2229,21 @@ void* FugaObject_match_(void* self, void* attempt)
     return result;
 }
 
+#ifdef TESTING
+TESTS(FugaObject_match_) {
+    void* self    = Fuga_init();
+    void* pattern = Fuga_clone(FUGA->Object);
+    void* value   = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(pattern, FUGA_INT(1))));
+    TEST(!Fuga_isRaised(Fuga_append_(pattern, FUGA_STRING("a"))));
+    TEST(!Fuga_isRaised(Fuga_append_(value,   FUGA_INT(1))));
+    TEST(Fuga_catch(Fuga_match_(pattern, value)) == FUGA->NoMatch);
+    TEST(!Fuga_isRaised(Fuga_append_(value,   FUGA_STRING("a"))));
+    TEST(!Fuga_isRaised(Fuga_match_(pattern, value)));
+    TEST(!Fuga_isRaised(Fuga_setI(value, 1, FUGA_STRING("b"))));
+    TEST(Fuga_catch(Fuga_match_(pattern, value)) == FUGA->NoMatch);
+    TEST(Fuga_isa_(FUGA->NoMatch, FUGA->MatchError));
+    Fuga_quit(self);
+}
+#endif
+
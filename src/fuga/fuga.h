@@ -21,6 +21,40 @@ typedef struct FugaMsg    FugaMsg;
 #include "slots.h"
 #include "symbols.h"
 
+/**
+*** ### FugaTail
+***
+*** A tail call waiting to be made. Code evaluated in tail position (see
+*** `FugaCode_evalTail`) may return `FUGA->Tail` instead of making its
+*** last call, and leave the call here for the caller to make: `method`
+*** with `recv` and `args`, or, if `method` is NULL, the evaluation of
+*** `code` in `scope`.
+**/
+typedef struct FugaTail FugaTail;
+struct FugaTail {
+    void* method;
+    void* recv;
+    void* args;
+    void* code;
+    void* scope;
+};
+
+/**
+*** ### FugaUnwind
+***
+*** A non-local exit on its way up. `break`, `continue` and `return`
+*** raise `FUGA->Break`, `FUGA->Continue` and `FUGA->Return` as they are
+*** (see `Fuga_isUnwind`), and leave the rest here: the value to exit
+*** with, and the call they were made in (see `FugaFrame_call`): the call
+*** `return` exits from, or the one whose loop `break` or `continue` is
+*** for. Whoever stops the exit empties it.
+**/
+typedef struct FugaUnwind FugaUnwind;
+struct FugaUnwind {
+    size_t call;
+    void* value;
+};
+
 struct FugaRoot {
     // GC info
     FugaGCList white;
@@ -31,6 +65,9 @@ struct FugaRoot {
     // symbols
     FugaSymbols* symbols;
 
+    // constant strings (see FugaString_const)
+    void* strings;
+
     // basic objects
     void* Object;
     void* Prelude;
@@ -47,6 +84,8 @@ struct FugaRoot {
     void* False;    // "false" is also reserved
     void* Path;
     void* Thunk;
+    void* Range;    // see FugaPrelude_range
+    void* Iter;     // see FugaPrelude_iter
 
     // Exceptions
     void* Exception;
@@ -57,8 +96,55 @@ struct FugaRoot {
     void* SyntaxError;
     void* SyntaxUnfinished;
     void* MatchError;
+    void* NoMatch;      // the MatchError that failed matches raise as is
+    void* RecursionError;
+    void* Break;        // raised as is by `break`, caught by loops
+    void* Continue;     // raised as is by `continue`, caught by loops
+    void* Return;       // raised as is by `return`, caught by calls
+
+    // tail calls (empty except between a tail call and its trampoline)
+    void* Tail;
+    FugaTail tail;
+
+    // non-local exits (empty except between an exit and where it stops)
+    FugaUnwind unwind;
+    size_t calls;       // the last id given to a call (see FugaFrame_call)
+
+    // memos, whose keys are weak (see FugaMemo_sweep)
+    void* memos;
+
+    // whether hot methods are compiled (see FugaJit)
+    bool jit;
+
+    // nested calls and thunk evaluations (see Fuga_enter)
+    size_t depth;
+    size_t depthLimit;
+    uintptr_t stackBase;
+    size_t stackLimit;
 };
 
+/**
+*** ### FUGA_DEPTH_LIMIT
+***
+*** The default for `FUGA->depthLimit`, the most calls and thunk
+*** evaluations that may be nested.
+***
+*** ### FUGA_STACK_LIMIT
+***
+*** The most C stack (in bytes) that nested calls and thunk evaluations
+*** may use by default. `FUGA->stackLimit` starts out as three quarters
+*** of the stack's soft limit (see `FUGA_PLATFORM_STACK_SIZE`), so that
+*** there's room left over however small the stack is, but no more than
+*** this. Where the stack's size can't be found out, it's this.
+**/
+#ifndef FUGA_DEPTH_LIMIT
+#define FUGA_DEPTH_LIMIT 100000
+#endif
+
+#ifndef FUGA_STACK_LIMIT
+#define FUGA_STACK_LIMIT (6 << 20)
+#endif
+
 struct FugaType {
     const char* name;
 };
@@ -69,6 +155,9 @@ struct FugaGCInfo {
     void        (*free) (void*);
     unsigned    pass;
     bool        root;
+    bool        embedded;       // a FugaSlots inside another object
+    bool        embedsSlots;    // preceded by its own FugaSlots
+    bool        frozen;         // a shared literal (see Fuga_freeze)
 };
 
 struct FugaHeader {
@@ -157,6 +246,15 @@ void Fuga_onFree_(void* self, void (*freeFn)(void*));
 **/
 void Fuga_mark_(void* self, void* child);
 
+/**
+*** ### Fuga_isMarked
+***
+*** Has the collection going on marked `self` yet? Objects that aren't
+*** marked once marking is over are about to be freed, so this is how
+*** weak references (see `FugaMemo_sweep`) find out that they've died.
+**/
+bool Fuga_isMarked(void* self);
+
 /**
 *** ### Fuga_collect
 ***
@@ -202,7 +300,8 @@ void Fuga_unroot(void* self);
 *** ## Prototyping
 *** ### Fuga_clone
 ***
-*** Create an empty object with a given prototype.
+*** Create an empty object with a given prototype. The object's storage
+*** for its first few slots is part of the same allocation.
 ***
 *** - Params:
 ***     - `void* proto`: the new object's prototype.
@@ -224,6 +323,15 @@ void* Fuga_clone(void* proto);
 **/
 void* Fuga_clone_(void* proto, size_t size);
 
+/**
+*** ### Fuga_cloneInline_
+***
+*** Like `Fuga_clone_`, for primitives that usually have a few slots of
+*** their own (msgs, for instance). Their storage for those slots is part
+*** of the same allocation, like `Fuga_clone`'s.
+**/
+void* Fuga_cloneInline_(void* proto, size_t size);
+
 /**
 *** ## Primitives
 *** ### Fuga_type
@@ -248,6 +356,21 @@ const FugaType* Fuga_type(void* self);
 **/
 void            Fuga_type_  (void* self, const FugaType* type);
 
+/**
+*** ### Fuga_freeze
+***
+*** Make an object immutable: setting, appending, deleting or adding
+*** slots to it raises a `TypeError` from then on. The parser freezes the
+*** literals it shares between occurrences (see `FugaParser_literal`), so
+*** that changing one can't change the others.
+***
+*** ### Fuga_isFrozen
+***
+*** Has `self` been frozen?
+**/
+void            Fuga_freeze   (void* self);
+bool            Fuga_isFrozen (void* self);
+
 /**
 *** ### Fuga_hasType_
 ***
@@ -465,6 +588,27 @@ void* Fuga_raise(void* self);
 **/
 void* Fuga_catch(void* self);
 
+/**
+*** ### Fuga_isUnwind
+***
+*** Is this exception, caught, one of the markers of a non-local exit
+*** (see `FugaUnwind`)? It's an identity test, so exits are told apart
+*** from errors without walking any protos.
+**/
+bool Fuga_isUnwind(void* self);
+
+/**
+*** ### Fuga_enter
+***
+*** Count one more level of nesting, before anything that may recurse
+*** on the C stack: method calls and thunk evaluations. Returns NULL, or,
+*** if that would nest deeper than `FUGA->depthLimit` or use more C stack
+*** than `FUGA->stackLimit` (measured from the outermost level), a raised
+*** `RecursionError`, so that runaway recursion unwinds as an exception
+*** rather than overflowing the stack.
+**/
+void* Fuga_enter(void* self);
+
 /**
 *** ### FUGA_RAISE
 ***
@@ -472,17 +616,39 @@ void* Fuga_catch(void* self);
 ***
 *** - Params:
 ***     - `void* type`: the exception prototype.
-***     - `const char* msg`: the error message.
+***     - `const char* msg`: the error message, usually a constant. The
+***     String made for it is shared with every other exception raised
+***     with the same message (see `FugaString_const`).
 *** - Return: no return -- this macro exits out of the
 *** calling procedure, returning the raised exception.
 **/
 #define FUGA_RAISE(type, msg)                                           \
     do {                                                                \
         void* error##__LINE__ = Fuga_clone(type);                       \
-        Fuga_setS(error##__LINE__, "msg", FUGA_STRING(msg));            \
+        Fuga_setS(error##__LINE__, "msg", FugaString_const(self, msg)); \
         return Fuga_raise(error##__LINE__);                             \
     } while(0)
 
+/**
+*** ### FUGA_ENTER
+***
+*** Count one more level of nesting (see `Fuga_enter`), or exit the
+*** calling procedure, returning the raised `RecursionError`. Every
+*** `FUGA_ENTER` that doesn't exit must be matched by a `FUGA_LEAVE`.
+***
+*** ### FUGA_LEAVE
+***
+*** Count one less level of nesting.
+**/
+#define FUGA_ENTER                                                      \
+    do {                                                                \
+        void* error##__LINE__ = Fuga_enter(self);                       \
+        if (error##__LINE__)                                            \
+            return error##__LINE__;                                     \
+    } while(0)
+
+#define FUGA_LEAVE      (FUGA->depth--)
+
 /**
 *** ### FUGA_CHECK
 ***
@@ -500,6 +666,17 @@ void* Fuga_catch(void* self);
         if (error##__LINE__)                                            \
             return Fuga_raise(error##__LINE__);                         \
     } while(0)
+/**
+*** ### FUGA_NO_MATCH
+***
+*** Fail a match: exit the calling procedure, returning `FUGA->NoMatch`,
+*** raised. That's a `MatchError` made once and for all, so a failed
+*** match allocates nothing. Code that tries patterns in turn catches it
+*** with `FUGA_CATCH_NO_MATCH`, and only makes an exception of its own if
+*** they all fail.
+**/
+#define FUGA_NO_MATCH   return Fuga_raise(FUGA->NoMatch)
+
 
 /**
 *** ### FUGA_TRY
@@ -519,15 +696,18 @@ void* Fuga_catch(void* self);
 ***     }
 ***
 *** As you can see, it's important to "break" or "return" from each catch
-*** statement, in order to avoid trigerring `FUGA_RERAISE`.
+*** statement, in order to avoid trigerring `FUGA_RERAISE`. Non-local
+*** exits (see `Fuga_isUnwind`) aren't exceptions to be handled: they're
+*** reraised at once, before any `FUGA_CATCH` is tried.
 ***
 *** - Params:
 ***     - `void* result`: the value to test.
 *** - Return: no return -- this is a macro that checks for exceptions
 *** and does different actions depending on the type of exception.
 **/
-#define FUGA_TRY(result)   \
-    for (void *exception = Fuga_catch(result); exception; exception=NULL)
+#define FUGA_TRY(result)                                                \
+    for (void *exception = Fuga_catch(result); exception; exception=NULL) \
+        if (Fuga_isUnwind(exception)) FUGA_RERAISE; else
 
 /**
 *** ### FUGA_CATCH
@@ -545,6 +725,17 @@ void* Fuga_catch(void* self);
 **/
 #define FUGA_CATCH(type) if (Fuga_isa_(exception, type))
 
+/**
+*** ### FUGA_CATCH_NO_MATCH
+***
+*** See `FUGA_TRY`.
+***
+*** Catch a failed match: `FUGA->NoMatch` (checked first, without walking
+*** protos), or a `MatchError` raised by a user-defined `match` method.
+**/
+#define FUGA_CATCH_NO_MATCH                                             \
+    if (exception == FUGA->NoMatch || Fuga_isa_(exception, FUGA->MatchError))
+
 /**
 *** ### FUGA_RERAISE
 ***
@@ -623,20 +814,22 @@ void* Fuga_delI      (void* self, long index);
 void* Fuga_append_   (void* self, void* value);
 void* Fuga_update_   (void* self, void* value);
 void* Fuga_extend_   (void* self, void* value);
+void* Fuga_reserve_  (void* self, long unnamed, long named);
 void* Fuga_copy      (void* self);
 
+// Only looks up slots that exist: a failed lookup builds an exception.
 #define FUGA_FOR(i, slot, arg)                                      \
     FUGA_NEED(arg);                                                 \
-    void* slot = Fuga_getI(arg, 0);                                 \
+    void* slot = NULL;                                              \
     for (long length = Fuga_length(arg),                            \
          i = 0;                                                     \
-         i < length;                                                \
-         i++,                                                       \
-         slot = Fuga_getI(arg, i))
+         i < length && (slot = Fuga_getI(arg, i));                  \
+         i++)
 
 // Calling & Sending
 void* Fuga_call (void* self, void* recv, void* args);
 void* Fuga_send (void* self, void* msg, void* args);
+void* Fuga_sendN(void* self, void* msg, size_t argc, void** argv);
 
 // Evaluation
 void* Fuga_eval         (void* self, void* recv, void* scope);
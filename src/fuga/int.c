@@ -8,8 +8,8 @@ void FugaInt_init(void* self)
     Fuga_setS(FUGA->Int, "str",   FUGA_METHOD_STR(FugaInt_str));
     Fuga_setS(FUGA->Int, "match", FUGA_METHOD_1(FugaInt_match_));
     Fuga_setS(FUGA->Int, "input", FUGA_METHOD(FugaInt_input));
-    Fuga_setS(FUGA->Int, "+",     FUGA_METHOD(FugaInt_addMethod));
-    Fuga_setS(FUGA->Int, "-",     FUGA_METHOD(FugaInt_subMethod));
+    Fuga_setS(FUGA->Int, "+",     FUGA_METHOD_V(FugaInt_addMethod));
+    Fuga_setS(FUGA->Int, "-",     FUGA_METHOD_V(FugaInt_subMethod));
     Fuga_setS(FUGA->Int, "*",     FUGA_METHOD_1(FugaInt_mul));
     Fuga_setS(FUGA->Int, "//",    FUGA_METHOD_1(FugaInt_fdiv));
     Fuga_setS(FUGA->Int, "%",     FUGA_METHOD_1(FugaInt_mod));
@@ -82,24 +82,24 @@ void* FugaInt_match_(FugaInt* self, FugaInt* other)
     FUGA_NEED(self);
     FUGA_NEED(other);
     if (!Fuga_isInt(self) || !Fuga_isInt(other))
-        FUGA_RAISE(FUGA->MatchError, "Int match: matches only on ints");
+        FUGA_NO_MATCH;
     if (self->value != other->value)
-        FUGA_RAISE(FUGA->MatchError, "Int match: values don't match");
+        FUGA_NO_MATCH;
     return Fuga_clone(FUGA->Object);
 }
 
-void* FugaInt_addMethod(void* _self, void* args)
+void* FugaInt_addMethod(void* _self, size_t argc, void** argv)
 {
     FugaInt* self = _self;
-    ALWAYS(self); ALWAYS(args);
-    FUGA_NEED(self); FUGA_NEED(args);
+    ALWAYS(self);
+    FUGA_NEED(self);
     if (!Fuga_isInt(self))
         FUGA_RAISE(FUGA->TypeError, "Int +: expected primitive int");
 
-    if (Fuga_hasLength_(args, 0)) {
+    if (argc == 0) {
         return self;
-    } else if (Fuga_hasLength_(args, 1)) {
-        FugaInt* other = Fuga_getI(args, 0);
+    } else if (argc == 1) {
+        FugaInt* other = argv[0];
         FUGA_NEED(other);
         if (!Fuga_isInt(other))
             FUGA_RAISE(FUGA->TypeError, "Int +: expected primitive int");
@@ -109,18 +109,18 @@ void* FugaInt_addMethod(void* _self, void* args)
     }
 }
 
-void* FugaInt_subMethod(void* _self, void* args)
+void* FugaInt_subMethod(void* _self, size_t argc, void** argv)
 {
     FugaInt* self = _self;
-    ALWAYS(self); ALWAYS(args);
-    FUGA_NEED(self); FUGA_NEED(args);
+    ALWAYS(self);
+    FUGA_NEED(self);
     if (!Fuga_isInt(self))
         FUGA_RAISE(FUGA->TypeError, "Int -: expected primitive int");
 
-    if (Fuga_hasLength_(args, 0)) {
+    if (argc == 0) {
         return FUGA_INT(-FugaInt_value(self));
-    } else if (Fuga_hasLength_(args, 1)) {
-        FugaInt* other = Fuga_getI(args, 0);
+    } else if (argc == 1) {
+        FugaInt* other = argv[0];
         FUGA_NEED(other);
         if (!Fuga_isInt(other))
             FUGA_RAISE(FUGA->TypeError, "Int -: expected primitive int");
@@ -253,6 +253,73 @@ void* FugaInt_ge(void* _self, void* _other)
     return FUGA_BOOL(FugaInt_value(self) >= FugaInt_value(other));
 }
 
+FugaIntOp FugaInt_op(void* self, void* name)
+{
+    ALWAYS(self); ALWAYS(name);
+    void* method = FugaSlots_valueBySymbol(FUGA_HEADER(FUGA->Int)->slots,
+                                           name);
+    if (!method)                                return FUGA_INT_NONE;
+    if (FugaMethodV_is_(method, FugaInt_addMethod)) return FUGA_INT_ADD;
+    if (FugaMethodV_is_(method, FugaInt_subMethod)) return FUGA_INT_SUB;
+    if (FugaMethod1_is_(method, FugaInt_mul))   return FUGA_INT_MUL;
+    if (FugaMethod1_is_(method, FugaInt_fdiv))  return FUGA_INT_FDIV;
+    if (FugaMethod1_is_(method, FugaInt_mod))   return FUGA_INT_MOD;
+    if (FugaMethod1_is_(method, FugaInt_eq))    return FUGA_INT_EQ;
+    if (FugaMethod1_is_(method, FugaInt_neq))   return FUGA_INT_NEQ;
+    if (FugaMethod1_is_(method, FugaInt_lt))    return FUGA_INT_LT;
+    if (FugaMethod1_is_(method, FugaInt_gt))    return FUGA_INT_GT;
+    if (FugaMethod1_is_(method, FugaInt_le))    return FUGA_INT_LE;
+    if (FugaMethod1_is_(method, FugaInt_ge))    return FUGA_INT_GE;
+    return FUGA_INT_NONE;
+}
+
+void* FugaInt_fused(FugaIntOp op, FugaInt* self, FugaInt* other)
+{
+    ALWAYS(self); ALWAYS(other);
+    ALWAYS(Fuga_isInt(self) && Fuga_isInt(other));
+    long a = self->value;
+    long b = other->value;
+    switch (op) {
+    case FUGA_INT_ADD:  return FUGA_INT(a + b);
+    case FUGA_INT_SUB:  return FUGA_INT(a - b);
+    case FUGA_INT_MUL:  return FUGA_INT(a * b);
+    case FUGA_INT_FDIV: return FugaInt_fdiv(self, other);
+    case FUGA_INT_MOD:  return FugaInt_mod(self, other);
+    case FUGA_INT_EQ:   return FUGA_BOOL(a == b);
+    case FUGA_INT_NEQ:  return FUGA_BOOL(a != b);
+    case FUGA_INT_LT:   return FUGA_BOOL(a <  b);
+    case FUGA_INT_GT:   return FUGA_BOOL(a >  b);
+    case FUGA_INT_LE:   return FUGA_BOOL(a <= b);
+    case FUGA_INT_GE:   return FUGA_BOOL(a >= b);
+    case FUGA_INT_NONE: break;
+    }
+    return NULL;
+}
+
+#ifdef TESTING
+TESTS(FugaInt_fused) {
+    void* self = Fuga_init();
+    void* a = FUGA_INT(7);
+    void* b = FUGA_INT(2);
+    FugaIntOp op = FugaInt_op(self, FUGA_SYMBOL("-"));
+    TEST(op == FUGA_INT_SUB);
+    TEST(FugaInt_is_(FugaInt_fused(op, a, b), 5));
+    TEST(FugaInt_is_(FugaInt_fused(FUGA_INT_FDIV, a, b), 3));
+    TEST(FugaInt_fused(FUGA_INT_LE, a, b) == FUGA->False);
+    TEST(Fuga_isRaised(FugaInt_fused(FUGA_INT_FDIV, a, FUGA_INT(0))));
+    TEST(FugaInt_op(self, FUGA_SYMBOL("str")) == FUGA_INT_NONE);
+
+    // once Int's method is replaced, it's no longer fused.
+    void* mul = FUGA_METHOD_1(FugaInt_mul);
+    TEST(!Fuga_isRaised(Fuga_setS(FUGA->Int, "-", mul)));
+    TEST(FugaInt_op(self, FUGA_SYMBOL("-")) == FUGA_INT_MUL);
+    TEST(!Fuga_isRaised(Fuga_setS(FUGA->Int, "-", FUGA->nil)));
+    TEST(FugaInt_op(self, FUGA_SYMBOL("-")) == FUGA_INT_NONE);
+
+    Fuga_quit(self);
+}
+#endif
+
 void* FugaInt_input(void* self, void* args) {
 	FUGA_NEED(self); FUGA_NEED(args);
 	long value;
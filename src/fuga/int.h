@@ -35,8 +35,20 @@ void* FugaInt_ge    (void*, void*);
 void* FugaInt_le    (void*, void*);
 
 // operators that are binary and unary
-void* FugaInt_addMethod(void* self, void* args);
-void* FugaInt_subMethod(void* self, void* args);
+void* FugaInt_addMethod(void* self, size_t argc, void** argv);
+void* FugaInt_subMethod(void* self, size_t argc, void** argv);
+
+// fused operators: which of the methods above Int's method `name` still
+// is, if any, and what it gives for two ints, without sending anything.
+typedef enum {
+    FUGA_INT_NONE,
+    FUGA_INT_ADD, FUGA_INT_SUB, FUGA_INT_MUL, FUGA_INT_FDIV, FUGA_INT_MOD,
+    FUGA_INT_EQ, FUGA_INT_NEQ, FUGA_INT_LT, FUGA_INT_GT, FUGA_INT_LE,
+    FUGA_INT_GE
+} FugaIntOp;
+
+FugaIntOp FugaInt_op(void* self, void* name);
+void* FugaInt_fused(FugaIntOp op, FugaInt* self, FugaInt* other);
 
 #endif
 
@@ -0,0 +1,683 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE     // for MAP_ANONYMOUS
+#endif
+
+#include "jit.h"
+#include "method.h"
+#include "frame.h"
+#include "prelude.h"
+#include "platform.h"
+#include "parser.h"
+#include "code.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if FUGA_PLATFORM_JIT
+#include <sys/mman.h>
+#endif
+
+// What compiled code returns (in rax and rdx): the value of the call, if
+// the status is FUGA_JIT_OK.
+typedef struct {
+    long value;
+    long status;
+} FugaJitResult;
+
+enum {
+    FUGA_JIT_BAIL,          // interpret the call instead
+    FUGA_JIT_OK,
+    FUGA_JIT_DEEP           // nested too deep: a RecursionError
+};
+
+typedef FugaJitResult (*FugaJitFn)(long* args, long depth);
+
+#define FUGA_JIT_NAMES 16
+
+struct FugaJit {
+    unsigned char* code;
+    size_t codeSize;
+    FugaJitFn fn;
+    long argc;
+    void* formals[FUGA_JIT_ARGC];   // their names
+    size_t frame;           // bytes of C stack a nested call takes
+
+    // The guards: what the method's objects and Int's slots had been
+    // written to, and what each name the body looks up resolved to, when
+    // it was compiled. Msgs are in the order they're nested in, so that
+    // one is only looked at if the ones it's in haven't changed.
+    void* objects[4];
+    size_t writes[4];
+    size_t intWrites;
+    void* names[FUGA_JIT_NAMES];
+    void* values[FUGA_JIT_NAMES];
+    long namesLength;
+    void** msgs;
+    size_t* msgWrites;
+    long msgsLength;
+    long msgsCapacity;
+};
+
+static size_t FugaJit_writes(void* object)
+{
+    FugaSlots* slots = FUGA_HEADER(object)->slots;
+    return slots ? FugaSlots_writes(slots) : 0;
+}
+
+void FugaJit_free(FugaJit* self)
+{
+    if (!self)
+        return;
+#if FUGA_PLATFORM_JIT
+    if (self->code)
+        munmap(self->code, self->codeSize);
+#endif
+    free(self->msgs);
+    free(self->msgWrites);
+    free(self);
+}
+
+void FugaJit_mark(void* method, FugaJit* self)
+{
+    if (!self)
+        return;
+    for (long i = 0; i < self->namesLength; i++) {
+        Fuga_mark_(method, self->names[i]);
+        Fuga_mark_(method, self->values[i]);
+    }
+}
+
+bool FugaJit_holds(FugaJit* jit, void* self)
+{
+    ALWAYS(jit); ALWAYS(self);
+    for (long i = 0; i < 4; i++)
+        if (FugaJit_writes(jit->objects[i]) != jit->writes[i])
+            return false;
+    for (long i = 0; i < jit->msgsLength; i++)
+        if (FugaJit_writes(jit->msgs[i]) != jit->msgWrites[i])
+            return false;
+    if (FugaSlots_writes(FUGA_HEADER(FUGA->Int)->slots) != jit->intWrites)
+        return false;
+    void* scope = Fuga_getS(self, "scope");
+    for (long i = 0; i < jit->namesLength; i++)
+        if (Fuga_get(scope, jit->names[i]) != jit->values[i])
+            return false;
+    return true;
+}
+
+#if FUGA_PLATFORM_JIT
+
+// An assembler for the few instructions the compiler needs. Code is put
+// together in a growing buffer, and copied into executable memory once
+// it's done.
+typedef struct {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+    bool failed;
+    long pushed;            // values on the stack right now...
+    long maxPushed;         // ... and at most
+    size_t deep, bail, exit, entry, start;
+} FugaJitAsm;
+
+static void FugaJitAsm_emit(FugaJitAsm* a, const char* bytes, size_t n)
+{
+    if (a->length + n > a->capacity) {
+        size_t capacity = a->capacity ? 2 * a->capacity : 256;
+        while (capacity < a->length + n)
+            capacity *= 2;
+        unsigned char* data = realloc(a->data, capacity);
+        if (!data) {
+            a->failed = true;
+            return;
+        }
+        a->data = data;
+        a->capacity = capacity;
+    }
+    memcpy(a->data + a->length, bytes, n);
+    a->length += n;
+}
+
+static void FugaJitAsm_int32(FugaJitAsm* a, int32_t value)
+{
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++)
+        bytes[i] = (uint32_t)value >> (8*i);
+    FugaJitAsm_emit(a, (char*)bytes, 4);
+}
+
+static void FugaJitAsm_int64(FugaJitAsm* a, long value)
+{
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++)
+        bytes[i] = (uint64_t)value >> (8*i);
+    FugaJitAsm_emit(a, (char*)bytes, 8);
+}
+
+// A jump (or call) to `target`, which has been emitted already.
+static void FugaJitAsm_jump(
+    FugaJitAsm* a,
+    const char* op,
+    size_t n,
+    size_t target
+) {
+    FugaJitAsm_emit(a, op, n);
+    FugaJitAsm_int32(a, (int32_t)(target - (a->length + 4)));
+}
+
+// A jump to a place that hasn't been emitted yet. Returns where its
+// offset goes, for FugaJitAsm_land.
+static size_t FugaJitAsm_forward(FugaJitAsm* a, const char* op, size_t n)
+{
+    FugaJitAsm_emit(a, op, n);
+    size_t at = a->length;
+    FugaJitAsm_int32(a, 0);
+    return at;
+}
+
+// Make the forward jump at `at` land here.
+static void FugaJitAsm_land(FugaJitAsm* a, size_t at)
+{
+    if (a->failed)
+        return;
+    int32_t offset = a->length - (at + 4);
+    for (int i = 0; i < 4; i++)
+        a->data[at + i] = (uint32_t)offset >> (8*i);
+}
+
+static void FugaJitAsm_push(FugaJitAsm* a)
+{
+    FugaJitAsm_emit(a, "\x50", 1);                      // push rax
+    if (++a->pushed > a->maxPushed)
+        a->maxPushed = a->pushed;
+}
+
+static void FugaJitAsm_pop(FugaJitAsm* a, const char* op)
+{
+    FugaJitAsm_emit(a, op, 1);
+    a->pushed--;
+}
+
+// Compiling a body.
+typedef struct {
+    FugaJit* jit;
+    FugaJitAsm* a;
+    void* method;
+    void* scope;
+} FugaJitCompiler;
+
+static bool FugaJit_expr(FugaJitCompiler* c, void* code, bool tail);
+
+// Is `code` a plain msg (with positional args only)? If it is, its
+// writes become a guard.
+static bool FugaJit_msg(FugaJitCompiler* c, void* code)
+{
+    void* self = c->method;
+    if (!Fuga_isMsg(code) || FUGA_HEADER(code)->proto != FUGA->Msg)
+        return false;
+    FugaSlots* slots = FUGA_HEADER(code)->slots;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    for (long i = 0; i < length; i++)
+        if (FugaSlots_getByIndex(slots, i).name)
+            return false;
+
+    FugaJit* jit = c->jit;
+    if (jit->msgsLength == jit->msgsCapacity) {
+        long capacity = jit->msgsCapacity ? 2 * jit->msgsCapacity : 16;
+        void** msgs = realloc(jit->msgs, capacity * sizeof(void*));
+        if (!msgs)
+            return false;
+        jit->msgs = msgs;
+        size_t* writes = realloc(jit->msgWrites, capacity * sizeof(size_t));
+        if (!writes)
+            return false;
+        jit->msgWrites = writes;
+        jit->msgsCapacity = capacity;
+    }
+    jit->msgs[jit->msgsLength] = code;
+    jit->msgWrites[jit->msgsLength] = FugaJit_writes(code);
+    jit->msgsLength++;
+    return true;
+}
+
+// The index of the formal called `name`, or -1.
+static long FugaJit_formal(FugaJitCompiler* c, void* name)
+{
+    for (long i = 0; i < c->jit->argc; i++)
+        if (c->jit->formals[i] == name)
+            return i;
+    return -1;
+}
+
+// What `name` resolves to in the method's scope, which becomes a guard.
+// NULL if it can't be relied on.
+static void* FugaJit_resolve(FugaJitCompiler* c, void* name)
+{
+    void* self = c->method;
+    FugaJit* jit = c->jit;
+    for (long i = 0; i < jit->namesLength; i++)
+        if (jit->names[i] == name)
+            return jit->values[i];
+    if (jit->namesLength == FUGA_JIT_NAMES || name == FUGA_SYMBOL("self"))
+        return NULL;
+    void* value = Fuga_get(c->scope, name);
+    if (Fuga_isRaised(value))
+        return NULL;
+    jit->names[jit->namesLength]  = name;
+    jit->values[jit->namesLength] = value;
+    jit->namesLength++;
+    return value;
+}
+
+// The primitive int operation a msg sends, if that's what it does.
+static FugaIntOp FugaJit_op(FugaJitCompiler* c, FugaMsg* msg)
+{
+    if (Fuga_length(msg) != 2)
+        return FUGA_INT_NONE;
+    void* value = FugaJit_resolve(c, msg->name);
+    void* op = value ? FugaMethodOp_op(value) : NULL;
+    return op ? FugaInt_op(c->method, op) : FUGA_INT_NONE;
+}
+
+// Evaluate both operands of an operator msg, into rax and rcx.
+static bool FugaJit_operands(FugaJitCompiler* c, void* msg)
+{
+    FugaJitAsm* a = c->a;
+    if (!FugaJit_expr(c, Fuga_getI(msg, 0), false))
+        return false;
+    FugaJitAsm_push(a);
+    if (!FugaJit_expr(c, Fuga_getI(msg, 1), false))
+        return false;
+    FugaJitAsm_emit(a, "\x48\x89\xC1", 3);              // mov rcx, rax
+    FugaJitAsm_pop(a, "\x58");                          // pop rax
+    return true;
+}
+
+static bool FugaJit_arith(FugaJitCompiler* c, void* msg, FugaIntOp op)
+{
+    FugaJitAsm* a = c->a;
+    if (!FugaJit_operands(c, msg))
+        return false;
+    switch (op) {
+    case FUGA_INT_ADD:
+        FugaJitAsm_emit(a, "\x48\x01\xC8", 3);          // add rax, rcx
+        break;
+    case FUGA_INT_SUB:
+        FugaJitAsm_emit(a, "\x48\x29\xC8", 3);          // sub rax, rcx
+        break;
+    case FUGA_INT_MUL:
+        FugaJitAsm_emit(a, "\x48\x0F\xAF\xC1", 4);      // imul rax, rcx
+        break;
+    case FUGA_INT_FDIV:
+    case FUGA_INT_MOD:
+        FugaJitAsm_emit(a, "\x48\x85\xC9", 3);          // test rcx, rcx
+        FugaJitAsm_jump(a, "\x0F\x84", 2, a->bail);     // jz bail
+        FugaJitAsm_emit(a, "\x48\x83\xF9\xFF", 4);      // cmp rcx, -1
+        FugaJitAsm_jump(a, "\x0F\x84", 2, a->bail);     // je bail
+        FugaJitAsm_emit(a, "\x48\x99", 2);              // cqo
+        FugaJitAsm_emit(a, "\x48\xF7\xF9", 3);          // idiv rcx
+        if (op == FUGA_INT_MOD)
+            FugaJitAsm_emit(a, "\x48\x89\xD0", 3);      // mov rax, rdx
+        return true;
+    default:
+        return false;
+    }
+    FugaJitAsm_jump(a, "\x0F\x80", 2, a->bail);         // jo bail
+    return true;
+}
+
+// A comparison that jumps (forward) when it's false. Returns where the
+// jump's offset goes, or 0 if `code` isn't a comparison of ints.
+static size_t FugaJit_cond(FugaJitCompiler* c, void* code)
+{
+    if (!FugaJit_msg(c, code))
+        return 0;
+    const char* jump;
+    switch (FugaJit_op(c, code)) {
+    case FUGA_INT_EQ:  jump = "\x0F\x85"; break;        // jne
+    case FUGA_INT_NEQ: jump = "\x0F\x84"; break;        // je
+    case FUGA_INT_LT:  jump = "\x0F\x8D"; break;        // jge
+    case FUGA_INT_GT:  jump = "\x0F\x8E"; break;        // jle
+    case FUGA_INT_LE:  jump = "\x0F\x8F"; break;        // jg
+    case FUGA_INT_GE:  jump = "\x0F\x8C"; break;        // jl
+    default: return 0;
+    }
+    if (!FugaJit_operands(c, code))
+        return 0;
+    FugaJitAsm_emit(c->a, "\x48\x39\xC8", 3);           // cmp rax, rcx
+    return FugaJitAsm_forward(c->a, jump, 2);
+}
+
+// if(cond, then, ..., else)
+static bool FugaJit_if(FugaJitCompiler* c, void* msg, bool tail)
+{
+    FugaJitAsm* a = c->a;
+    long length = Fuga_length(msg);
+    if (length < 3 || !(length & 1))
+        return false;
+    size_t ends[length/2];
+    for (long i = 0; i < length-1; i += 2) {
+        size_t otherwise = FugaJit_cond(c, Fuga_getI(msg, i));
+        if (!otherwise || !FugaJit_expr(c, Fuga_getI(msg, i+1), tail))
+            return false;
+        ends[i/2] = FugaJitAsm_forward(a, "\xE9", 1);   // jmp end
+        FugaJitAsm_land(a, otherwise);
+    }
+    if (!FugaJit_expr(c, Fuga_getI(msg, length-1), tail))
+        return false;
+    for (long i = 0; i < length/2; i++)
+        FugaJitAsm_land(a, ends[i]);
+    return true;
+}
+
+// A call of the method itself. The args go on the stack, in order from
+// the top, which is where the callee finds them; a tail call copies them
+// over its own args instead, and starts again.
+static bool FugaJit_recurse(FugaJitCompiler* c, void* msg, bool tail)
+{
+    FugaJitAsm* a = c->a;
+    long argc = c->jit->argc;
+    for (long i = argc-1; i >= 0; i--) {
+        if (!FugaJit_expr(c, Fuga_getI(msg, i), false))
+            return false;
+        FugaJitAsm_push(a);
+    }
+    if (tail) {
+        for (long i = 0; i < argc; i++) {
+            FugaJitAsm_pop(a, "\x58");                  // pop rax
+            FugaJitAsm_emit(a, "\x48\x89\x83", 3);      // mov [rbx+8i], rax
+            FugaJitAsm_int32(a, 8*i);
+        }
+        FugaJitAsm_jump(a, "\xE9", 1, a->start);        // jmp start
+        return true;
+    }
+    FugaJitAsm_emit(a, "\x48\x89\xE7", 3);              // mov rdi, rsp
+    FugaJitAsm_emit(a, "\x49\x8D\x74\x24\xFF", 5);      // lea rsi, [r12-1]
+    FugaJitAsm_jump(a, "\xE8", 1, a->entry);            // call entry
+    if (argc) {
+        FugaJitAsm_emit(a, "\x48\x81\xC4", 3);          // add rsp, 8*argc
+        FugaJitAsm_int32(a, 8*argc);
+        a->pushed -= argc;
+    }
+    FugaJitAsm_emit(a, "\x48\x83\xFA\x01", 4);          // cmp rdx, OK
+    FugaJitAsm_jump(a, "\x0F\x85", 2, a->exit);         // jne exit
+    return true;
+}
+
+static bool FugaJit_expr(FugaJitCompiler* c, void* code, bool tail)
+{
+    void* self = c->method;
+    FugaJitAsm* a = c->a;
+    if (Fuga_isInt(code)) {
+        if (FUGA_HEADER(code)->slots || FUGA_HEADER(code)->proto != FUGA->Int)
+            return false;
+        long value = FugaInt_value(code);
+        if (value == (int32_t)value) {
+            FugaJitAsm_emit(a, "\x48\xC7\xC0", 3);      // mov rax, imm32
+            FugaJitAsm_int32(a, value);
+        } else {
+            FugaJitAsm_emit(a, "\x48\xB8", 2);          // mov rax, imm64
+            FugaJitAsm_int64(a, value);
+        }
+        return true;
+    }
+    if (!FugaJit_msg(c, code))
+        return false;
+    FugaMsg* msg = code;
+    long length = Fuga_length(msg);
+    long formal = FugaJit_formal(c, msg->name);
+    if (formal >= 0) {
+        if (length)
+            return false;
+        FugaJitAsm_emit(a, "\x48\x8B\x83", 3);          // mov rax, [rbx+8i]
+        FugaJitAsm_int32(a, 8*formal);
+        return true;
+    }
+    void* value = FugaJit_resolve(c, msg->name);
+    if (!value)
+        return false;
+    if (value == c->method && length == c->jit->argc)
+        return FugaJit_recurse(c, msg, tail);
+    if (FugaMethodT_is_(value, FugaPrelude_if))
+        return FugaJit_if(c, msg, tail);
+    FugaIntOp op = FugaJit_op(c, msg);
+    if (op >= FUGA_INT_ADD && op <= FUGA_INT_MOD)
+        return FugaJit_arith(c, msg, op);
+    return false;
+}
+
+// Compile the body, between a prologue that keeps the args in rbx and
+// the depth left in r12, and the ways out, which come first so that
+// every jump to them goes back.
+static bool FugaJit_compile(FugaJitCompiler* c, void* body)
+{
+    FugaJitAsm* a = c->a;
+    a->deep = a->length;
+    FugaJitAsm_emit(a, "\xBA\x02\x00\x00\x00", 5);      // mov edx, DEEP
+    FugaJitAsm_emit(a, "\xEB\x02", 2);                  // jmp exit
+    a->bail = a->length;
+    FugaJitAsm_emit(a, "\x31\xD2", 2);                  // xor edx, edx
+    a->exit = a->length;
+    FugaJitAsm_emit(a, "\x48\x8D\x65\xF0", 4);          // lea rsp, [rbp-16]
+    FugaJitAsm_emit(a, "\x41\x5C\x5B\x5D\xC3", 5);      // pop r12 rbx rbp; ret
+    a->entry = a->length;
+    FugaJitAsm_emit(a, "\x55\x48\x89\xE5", 4);          // push rbp; mov rbp,rsp
+    FugaJitAsm_emit(a, "\x53\x41\x54", 3);              // push rbx; push r12
+    FugaJitAsm_emit(a, "\x48\x89\xFB", 3);              // mov rbx, rdi
+    FugaJitAsm_emit(a, "\x49\x89\xF4", 3);              // mov r12, rsi
+    FugaJitAsm_emit(a, "\x4D\x85\xE4", 3);              // test r12, r12
+    FugaJitAsm_jump(a, "\x0F\x8E", 2, a->deep);         // jle deep
+    a->start = a->length;
+    if (!FugaJit_expr(c, body, true))
+        return false;
+    FugaJitAsm_emit(a, "\xBA\x01\x00\x00\x00", 5);      // mov edx, OK
+    FugaJitAsm_jump(a, "\xE9", 1, a->exit);             // jmp exit
+    return !a->failed;
+}
+
+FugaJit* FugaJit_new(void* method)
+{
+    void* self = method;
+    ALWAYS(method);
+    void* scope    = Fuga_getS(method, "scope");
+    void* patterns = Fuga_getS(method, "args");
+    void* bodies   = Fuga_getS(method, "body");
+    if (Fuga_isRaised(scope) || Fuga_isRaised(patterns)
+        || Fuga_isRaised(bodies) || !Fuga_hasLength_(patterns, 1)
+        || !Fuga_hasLength_(bodies, 1))
+        return NULL;
+    void* formals = Fuga_getI(patterns, 0);
+    void* body    = Fuga_getI(bodies, 0);
+    if (!Fuga_isRaised(body))
+        body = FugaCode_source(body);
+    if (Fuga_isRaised(body) || !FugaFrame_binds(formals)
+        || Fuga_length(formals) > FUGA_JIT_ARGC)
+        return NULL;
+
+    FugaJit* jit = calloc(1, sizeof(FugaJit));
+    if (!jit)
+        return NULL;
+    jit->argc = Fuga_length(formals);
+    for (long i = 0; i < jit->argc; i++)
+        jit->formals[i] = ((FugaMsg*)Fuga_getI(formals, i))->name;
+    void* objects[4] = {method, patterns, bodies, formals};
+    for (long i = 0; i < 4; i++) {
+        jit->objects[i] = objects[i];
+        jit->writes[i]  = FugaJit_writes(objects[i]);
+    }
+    jit->intWrites = FugaSlots_writes(FUGA_HEADER(FUGA->Int)->slots);
+
+    FugaJitAsm a = {.data = NULL};
+    FugaJitCompiler c = {
+        .jit = jit, .a = &a, .method = method, .scope = scope
+    };
+    bool compiled = FugaJit_compile(&c, body);
+    if (compiled) {
+        jit->codeSize = a.length;
+        jit->code = mmap(NULL, a.length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (jit->code == MAP_FAILED) {
+            jit->code = NULL;
+            compiled = false;
+        } else {
+            memcpy(jit->code, a.data, a.length);
+            compiled = !mprotect(jit->code, a.length, PROT_READ|PROT_EXEC);
+        }
+    }
+    free(a.data);
+    if (!compiled) {
+        FugaJit_free(jit);
+        return NULL;
+    }
+    // (ISO C has no conversion from data pointers to function pointers.)
+    unsigned char* entry = jit->code + a.entry;
+    memcpy(&jit->fn, &entry, sizeof(jit->fn));
+    jit->frame = 8 * (4 + a.maxPushed);
+    return jit;
+}
+
+void* FugaJit_call(FugaJit* jit, void* self)
+{
+    ALWAYS(jit); ALWAYS(self);
+    FugaSlots* slots = FUGA_HEADER(self)->slots;
+    if (!slots || (long)FugaSlots_length(slots) != jit->argc + 1)
+        return NULL;
+    long args[FUGA_JIT_ARGC];
+    for (long i = 0; i < jit->argc; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(slots, i+1);
+        void* value = slot.value;
+        if (slot.name != jit->formals[i] || !Fuga_isInt(value) || FUGA_HEADER(value)->slots
+            || FUGA_HEADER(value)->proto != FUGA->Int)
+            return NULL;
+        args[i] = FugaInt_value(value);
+    }
+
+    // Nested calls get the stack and depth that Fuga_enter would have
+    // left them.
+    uintptr_t here = (uintptr_t)&slots;
+    uintptr_t used = !FUGA->depth ? 0
+                   : here < FUGA->stackBase ? FUGA->stackBase - here
+                                            : here - FUGA->stackBase;
+    long depth = used < FUGA->stackLimit
+               ? (FUGA->stackLimit - used) / jit->frame : 0;
+    if (depth > (long)(FUGA->depthLimit - FUGA->depth))
+        depth = FUGA->depthLimit - FUGA->depth;
+
+    FugaJitResult result = jit->fn(args, depth);
+    if (result.status == FUGA_JIT_DEEP)
+        FUGA_RAISE(FUGA->RecursionError,
+            "maximum recursion depth exceeded"
+        );
+    if (result.status != FUGA_JIT_OK)
+        return NULL;
+    return FUGA_INT(result.value);
+}
+
+#else
+
+FugaJit* FugaJit_new(void* method)
+{
+    return NULL;
+}
+
+void* FugaJit_call(FugaJit* jit, void* frame)
+{
+    return NULL;
+}
+
+#endif
+
+#ifdef TESTING
+
+// Evaluate `code` in a new scope, and return that scope.
+static void* FugaJit_test_run(void* self, const char* code)
+{
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser, code);
+    void* block = FugaParser_block(parser);
+    FUGA_CHECK(block);
+    FUGA_CHECK(Fuga_setS(scope, "_this", scope));
+    FUGA_CHECK(FugaCode_evalIn(block, scope));
+    return scope;
+}
+
+TESTS(FugaJit) {
+    void* self = Fuga_init();
+    void* scope = FugaJit_test_run(self,
+        "fib(n) { if(n < 2, n, fib(n - 1) + fib(n - 2)) }\n"
+        "sum(n, acc) { if(n == 0, acc, sum(n - 1, acc + n)) }\n"
+        "big(n) { n * 4611686018427387904 }\n"
+        "div(a, b) { a // b * 10 + a % b }\n"
+        "side(n) { print(n) }\n"
+    );
+    TEST(!Fuga_isRaised(scope));
+    void* fib = Fuga_getS(scope, "fib");
+    FugaJit* jit = FugaJit_new(fib);
+    TEST(!FUGA_PLATFORM_JIT || jit);
+    TEST(!FugaJit_new(Fuga_getS(scope, "side")));
+
+#if FUGA_PLATFORM_JIT
+    TEST(FugaJit_holds(jit, fib));
+    void* frame = FugaFrame_new(scope);
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "self", scope)));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "n", FUGA_INT(20))));
+    TEST(FugaInt_is_(FugaJit_call(jit, frame), 6765));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "n", FUGA_STRING("20"))));
+    TEST(FugaJit_call(jit, frame) == NULL);
+
+    // guards: redefining an operator the body uses, in its scope...
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "+", FUGA->nil)));
+    TEST(!FugaJit_holds(jit, fib));
+    TEST(!Fuga_isRaised(Fuga_delS(scope, "+")));
+    TEST(FugaJit_holds(jit, fib));
+    // ... or one of Int's methods.
+    TEST(!Fuga_isRaised(Fuga_setS(FUGA->Int, "frob", FUGA->nil)));
+    TEST(!FugaJit_holds(jit, fib));
+    FugaJit_free(jit);
+
+    // tail calls are loops, and overflow bails out.
+    FugaJit* sum = FugaJit_new(Fuga_getS(scope, "sum"));
+    TEST(sum);
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "n", FUGA_INT(1000000))));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "acc", FUGA_INT(0))));
+    TEST(FugaInt_is_(FugaJit_call(sum, frame), 500000500000));
+    FugaJit_free(sum);
+    FugaJit* big = FugaJit_new(Fuga_getS(scope, "big"));
+    TEST(big);
+    frame = FugaFrame_new(scope);
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "self", scope)));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "n", FUGA_INT(1))));
+    TEST(FugaInt_is_(FugaJit_call(big, frame), 4611686018427387904));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "n", FUGA_INT(2))));
+    TEST(FugaJit_call(big, frame) == NULL);
+    FugaJit_free(big);
+
+    // division by zero is left to the interpreter.
+    FugaJit* div = FugaJit_new(Fuga_getS(scope, "div"));
+    TEST(div);
+    frame = FugaFrame_new(scope);
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "self", scope)));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "a", FUGA_INT(-7))));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "b", FUGA_INT(2))));
+    TEST(FugaInt_is_(FugaJit_call(div, frame), -1));
+    TEST(!Fuga_isRaised(Fuga_setS(frame, "b", FUGA_INT(0))));
+    TEST(FugaJit_call(div, frame) == NULL);
+    FugaJit_free(div);
+#endif
+
+    // and calls give the same results with or without it.
+    for (int on = 0; on < 2; on++) {
+        FUGA->jit = on;
+        scope = FugaJit_test_run(self,
+            "fib(n) { if(n < 2, n, fib(n - 1) + fib(n - 2)) }\n"
+            "a = fib(20)\n"
+        );
+        TEST(FugaInt_is_(Fuga_getS(scope, "a"), 6765));
+    }
+
+    Fuga_quit(self);
+}
+#endif
+
@@ -0,0 +1,86 @@
+#ifndef FUGA_JIT_H
+#define FUGA_JIT_H
+
+#include "fuga.h"
+
+/**
+*** # FugaJit
+***
+*** Compiled code for a Fuga method, in x86-64 machine code. A method is
+*** compiled once it's been called `FUGA_JIT_CALLS` times, if it can be:
+*** it must have a single pattern of plain names (see `FugaFrame_binds`),
+*** and a body made only of
+***
+*** - int literals and the method's formals,
+*** - the int operators `+`, `-`, `*`, `//` and `%`,
+*** - `if` with an else branch, on the comparisons `==`, `!=`, `<`, `>`,
+***   `<=` and `>=`,
+*** - calls of the method itself by name (in tail position, these jump
+***   back to the start rather than call).
+***
+*** The compiled code works on unboxed ints, and allocates nothing. It's
+*** only run when every arg is a plain int, and while the names the body
+*** looks up (the operators, `if` and the method's own name) resolve to
+*** what they did when it was compiled, Int's methods are the ones it
+*** started out with, and the method and its body haven't been written
+*** to -- the guards a send would check, checked once on the way in. If
+*** an operation would overflow or divide by zero, the code bails out and
+*** the call is interpreted from the start, which is safe because the
+*** body has no side effects.
+***
+*** There's only a code generator for x86-64 Linux (see
+*** `FUGA_PLATFORM_JIT`); elsewhere, nothing is ever compiled. Setting
+*** the `FUGA_NOJIT` environment variable, or `FUGA->jit` to false, turns
+*** it off.
+***
+*** ### FUGA_JIT_CALLS
+***
+*** How many calls it takes before a method is compiled.
+***
+*** ### FUGA_JIT_ARGC
+***
+*** The most formals a compiled method can have.
+**/
+#ifndef FUGA_JIT_CALLS
+#define FUGA_JIT_CALLS 64
+#endif
+
+#define FUGA_JIT_ARGC 8
+
+typedef struct FugaJit FugaJit;
+
+/**
+*** ### FugaJit_new
+***
+*** Compile `method`, a Fuga method. Returns NULL if it can't be compiled.
+***
+*** ### FugaJit_free
+***
+*** Free compiled code.
+***
+*** ### FugaJit_mark
+***
+*** Mark what the guards of compiled code compare against. `method` is
+*** the method the code belongs to.
+**/
+FugaJit* FugaJit_new(void* method);
+void FugaJit_free(FugaJit* self);
+void FugaJit_mark(void* method, FugaJit* self);
+
+/**
+*** ### FugaJit_holds
+***
+*** Is compiled code still good for `method`? Once it isn't, it never
+*** will be again, and should be freed.
+***
+*** ### FugaJit_call
+***
+*** Run compiled code in `frame`, a frame just bound by the method's
+*** pattern. Returns the value of the call, or NULL if it must be
+*** interpreted instead.
+**/
+bool FugaJit_holds(FugaJit* self, void* method);
+void* FugaJit_call(FugaJit* self, void* frame);
+
+#endif
+
@@ -50,7 +50,9 @@ void* Fuga_needOnce(FugaLazy* self)
     FUGA_CHECK(self);
     if (Fuga_isLazy(self)) {
         if (self->scope) {
+            FUGA_ENTER;
             void* res = Fuga_eval(self->code, self->scope, self->scope);
+            FUGA_LEAVE;
             FUGA_CHECK(res);
             self->code  = res;
             self->scope = NULL;
@@ -105,3 +107,70 @@ void* Fuga_lazySlots(void* _self)
 
     return result;
 }
+
+/**
+ * Split a thunk into its code and its scope. If it has been evaluated
+ * already (or isn't a thunk), the code is its value and the scope NULL.
+ */
+void* Fuga_lazySplit(void* _self, void** scope)
+{
+    FugaLazy* self = _self;
+    ALWAYS(self); ALWAYS(scope);
+    FUGA_CHECK(self);
+    while (Fuga_isLazy(self) && !self->scope)
+        self = self->code;
+    *scope = Fuga_isLazy(self) ? self->scope : NULL;
+    return Fuga_isLazy(self) ? self->code : self;
+}
+
+/**
+ * Evaluate one slot of the code of a thunk split with Fuga_lazySplit,
+ * as if it were a thunk of its own, but without making one. With a
+ * NULL scope, code is a value already.
+ */
+void* Fuga_needIn(void* self, void* scope)
+{
+    ALWAYS(self);
+    FUGA_CHECK(self);
+    if (!scope)
+        return Fuga_need(self);
+    if (FugaMsg_is_(self, "~") && Fuga_hasLength_(self, 1)) {
+        FugaThunk* thunk = Fuga_eval(Fuga_getI(self, 0), scope, scope);
+        FUGA_CHECK(thunk);
+        return Fuga_need(FugaThunk_lazy(thunk));
+    }
+    FUGA_ENTER;
+    void* result = Fuga_eval(self, scope, scope);
+    FUGA_LEAVE;
+    return Fuga_need(result);
+}
+
+/**
+ * Like Fuga_lazySlots, but put the args in argv (at most max of them)
+ * rather than in a new object, and don't make thunks for literals.
+ * Returns NULL, or a raised exception.
+ */
+void* Fuga_lazyArgs(void* _self, size_t* argc, void** argv, size_t max)
+{
+    ALWAYS(_self); ALWAYS(argc); ALWAYS(argv);
+    void* scope;
+    void* code = Fuga_lazySplit(_self, &scope);
+    FUGA_CHECK(code);
+
+    FugaSlots* slots = FUGA_HEADER(code)->slots;
+    *argc = slots ? FugaSlots_length(slots) : 0;
+    for (size_t i = 0; i < *argc && i < max; i++) {
+        void* slot = FugaSlots_getByIndex(slots, i).value;
+        if (!scope || Fuga_isInt(slot) || Fuga_isString(slot)
+                   || Fuga_isSymbol(slot)) {
+            argv[i] = slot;
+        } else if (FugaMsg_is_(slot, "~") && Fuga_hasLength_(slot, 1)) {
+            FugaThunk* thunk = Fuga_eval(Fuga_getI(slot, 0), scope, scope);
+            FUGA_CHECK(thunk);
+            argv[i] = FugaThunk_lazy(thunk);
+        } else {
+            argv[i] = Fuga_lazy_(slot, scope);
+        }
+    }
+    return NULL;
+}
@@ -15,6 +15,9 @@ void* Fuga_lazy_        (void* self, void* scope);
 void* Fuga_lazyCode     (FugaLazy* self);
 void* Fuga_lazyScope    (FugaLazy* self);
 void* Fuga_lazySlots    (void* self);
+void* Fuga_lazyArgs     (void* self, size_t* argc, void** argv, size_t max);
+void* Fuga_lazySplit    (void* self, void** scope);
+void* Fuga_needIn       (void* self, void* scope);
 void* Fuga_needSlots    (FugaLazy* self);
 
 #define FUGA_NEED(value)                                                \
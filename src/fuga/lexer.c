@@ -291,8 +291,7 @@ void _FugaLexer_lexInt(
         value += self->code[i] - '0';
     }
     self->token->type = FUGA_TOKEN_INT;
-    self->token->value = malloc(sizeof(long));
-    *(long*)self->token->value = value;
+    self->token->number = value;
     _FugaLexer_consume_(self, i);
 }
 
@@ -450,7 +449,7 @@ bool _FugaToken_test_int_(
 ) {
     if (self->type != type)
         return false;
-    return self->value && (*(long*)self->value == value);
+    return self->number == value;
 }
 
 bool _FugaLexer_test_(
@@ -0,0 +1,499 @@
+#include "memo.h"
+#include "test.h"
+#include "parser.h"
+#include "code.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// An arg, as a memo compares it.
+typedef struct {
+    enum {
+        FUGA_MEMO_INT,
+        FUGA_MEMO_STRING,
+        FUGA_MEMO_OBJECT
+    } kind;
+    long  number;               // an int's value
+    void* object;               // a string, or any other object (weak)
+} FugaMemoKey;
+
+// A remembered call. Entries that aren't in use are chained together
+// through `chain`, from `FugaMemo.unused`.
+typedef struct {
+    size_t hash;
+    size_t argc;
+    FugaMemoKey recv;
+    FugaMemoKey keys[FUGA_MEMO_ARGC];
+    void* value;
+    long chain;                 // the next entry in its bucket, or -1
+    long older;                 // the entry used just before, or -1
+    long newer;                 // the entry used just after, or -1
+} FugaMemoEntry;
+
+struct FugaMemo {
+    void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
+    void* method;
+    bool byRecv;                // whether the receiver counts too
+    FugaMemo* next;             // the next memo in FUGA->memos
+    long capacity;
+    long size;
+    size_t mask;                // the number of buckets, less one
+    long* buckets;
+    FugaMemoEntry* entries;
+    long unused;
+    long oldest;
+    long newest;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+};
+
+static FugaMemoKey FugaMemo_key(void* self, size_t* hash)
+{
+    FugaMemoKey key = {.kind = FUGA_MEMO_OBJECT, .number = 0, .object = self};
+    size_t h;
+    if (Fuga_isInt(self)) {
+        key.kind   = FUGA_MEMO_INT;
+        key.number = FugaInt_value(self);
+        key.object = NULL;
+        h = (size_t)key.number;
+    } else if (Fuga_isString(self)) {
+        FugaString* string = self;
+        key.kind = FUGA_MEMO_STRING;
+        h = FugaString_hash(string->data, string->size);
+    } else {
+        h = (size_t)self >> 4;
+    }
+    *hash = (*hash ^ h ^ key.kind) * 1099511628211u;
+    return key;
+}
+
+static bool FugaMemoKey_equals(FugaMemoKey a, FugaMemoKey b)
+{
+    if (a.kind != b.kind)
+        return false;
+    FugaString* x = a.object;
+    FugaString* y = b.object;
+    switch (a.kind) {
+    case FUGA_MEMO_INT:
+        return a.number == b.number;
+    case FUGA_MEMO_STRING:
+        return x == y || (x->size == y->size && x->length == y->length
+                          && !memcmp(x->data, y->data, x->size));
+    default:
+        return a.object == b.object;
+    }
+}
+
+static void FugaMemo_mark(void* _self)
+{
+    FugaMemo* self = _self;
+    Fuga_mark_(self, self->method);
+    for (long i = self->newest; i >= 0; i = self->entries[i].older)
+        Fuga_mark_(self, self->entries[i].value);
+}
+
+static void FugaMemo_free(void* _self)
+{
+    FugaMemo* self = _self;
+    FugaMemo** link = (FugaMemo**)&FUGA->memos;
+    while (*link && *link != self)
+        link = &(*link)->next;
+    if (*link)
+        *link = self->next;
+    free(self->buckets);
+    free(self->entries);
+}
+
+void* FugaMemo_call(void* self, void* recv, void* args);
+void* FugaMemo_strict(void* self, void* recv, size_t argc, void** argv);
+
+static bool FugaMemo_is(void* _self)
+{
+    FugaMemo* self = _self;
+    return Fuga_isMethod(self) && self->call == FugaMemo_call;
+}
+
+void* FugaMemo_new(void* method, long capacity)
+{
+    ALWAYS(method);
+    void* self = method;
+    FUGA_NEED(method);
+    if (!Fuga_isMethod(method))
+        FUGA_RAISE(FUGA->TypeError, "memo: expected a method");
+    if (capacity < 1)
+        FUGA_RAISE(FUGA->ValueError, "memo: expected a positive capacity");
+    if (FugaMemo_is(method))
+        return method;
+
+    FugaMemo* result = Fuga_clone_(FUGA->Method, sizeof *result);
+    Fuga_type_(result, Fuga_type(method));
+    result->call     = FugaMemo_call;
+    result->strict   = FugaMemo_strict;
+    result->method   = method;
+    result->byRecv   = true;
+    result->capacity = capacity;
+    size_t buckets = 1;
+    while (buckets < (size_t)capacity)
+        buckets <<= 1;
+    result->mask    = buckets - 1;
+    result->buckets = malloc(buckets * sizeof *result->buckets);
+    result->entries = malloc(capacity * sizeof *result->entries);
+    ALWAYS(result->buckets); ALWAYS(result->entries);
+    for (size_t i = 0; i < buckets; i++)
+        result->buckets[i] = -1;
+    for (long i = 0; i < capacity; i++)
+        result->entries[i].chain = i+1 < capacity ? i+1 : -1;
+    result->unused = 0;
+    result->oldest = result->newest = -1;
+    result->next = FUGA->memos;
+    FUGA->memos  = result;
+    Fuga_onMark_(result, FugaMemo_mark);
+    Fuga_onFree_(result, FugaMemo_free);
+    return result;
+}
+
+static long FugaMemo_find(
+    FugaMemo* self,
+    size_t hash,
+    FugaMemoKey recv,
+    size_t argc,
+    FugaMemoKey* keys
+) {
+    for (long i = self->buckets[hash & self->mask]; i >= 0;
+         i = self->entries[i].chain) {
+        FugaMemoEntry* entry = &self->entries[i];
+        if (entry->hash != hash || entry->argc != argc
+                                || !FugaMemoKey_equals(entry->recv, recv))
+            continue;
+        size_t j = 0;
+        while (j < argc && FugaMemoKey_equals(entry->keys[j], keys[j]))
+            j++;
+        if (j == argc)
+            return i;
+    }
+    return -1;
+}
+
+// Take an entry out of the LRU order.
+static void FugaMemo_unlink(FugaMemo* self, long i)
+{
+    FugaMemoEntry* entry = &self->entries[i];
+    if (entry->older >= 0)
+        self->entries[entry->older].newer = entry->newer;
+    else
+        self->oldest = entry->newer;
+    if (entry->newer >= 0)
+        self->entries[entry->newer].older = entry->older;
+    else
+        self->newest = entry->older;
+}
+
+// Put an entry at the recently used end of the LRU order.
+static void FugaMemo_touch(FugaMemo* self, long i)
+{
+    FugaMemoEntry* entry = &self->entries[i];
+    entry->older = self->newest;
+    entry->newer = -1;
+    if (self->newest >= 0)
+        self->entries[self->newest].newer = i;
+    else
+        self->oldest = i;
+    self->newest = i;
+}
+
+// Forget an entry.
+static void FugaMemo_remove(FugaMemo* self, long i)
+{
+    FugaMemoEntry* entry = &self->entries[i];
+    long* link = &self->buckets[entry->hash & self->mask];
+    while (*link != i)
+        link = &self->entries[*link].chain;
+    *link = entry->chain;
+    FugaMemo_unlink(self, i);
+    entry->value = NULL;
+    entry->chain = self->unused;
+    self->unused = i;
+    self->size--;
+}
+
+static void FugaMemo_insert(
+    FugaMemo* self,
+    size_t hash,
+    FugaMemoKey recv,
+    size_t argc,
+    FugaMemoKey* keys,
+    void* value
+) {
+    if (self->unused < 0) {
+        FugaMemo_remove(self, self->oldest);
+        self->evictions++;
+    }
+    long i = self->unused;
+    FugaMemoEntry* entry = &self->entries[i];
+    self->unused = entry->chain;
+    entry->hash  = hash;
+    entry->recv  = recv;
+    entry->argc  = argc;
+    memcpy(entry->keys, keys, argc * sizeof *keys);
+    entry->value = value;
+    entry->chain = self->buckets[hash & self->mask];
+    self->buckets[hash & self->mask] = i;
+    FugaMemo_touch(self, i);
+    self->size++;
+}
+
+// Answer a call from the table, or make it and remember what it returns.
+// The args are in `argv`, and in `args` too if it isn't NULL.
+static void* FugaMemo_lookup(
+    FugaMemo* self,
+    void* recv,
+    size_t argc,
+    void** argv,
+    void* args
+) {
+    if (argc > FUGA_MEMO_ARGC)
+        return FugaMethod_call(self->method, recv, args);
+    size_t hash = 14695981039346656037u;
+    FugaMemoKey recvKey = {.kind = FUGA_MEMO_INT, .number = 0};
+    if (self->byRecv)
+        recvKey = FugaMemo_key(recv, &hash);
+    FugaMemoKey keys[FUGA_MEMO_ARGC];
+    for (size_t i = 0; i < argc; i++)
+        keys[i] = FugaMemo_key(argv[i], &hash);
+
+    long i = FugaMemo_find(self, hash, recvKey, argc, keys);
+    if (i >= 0) {
+        self->hits++;
+        FugaMemo_unlink(self, i);
+        FugaMemo_touch(self, i);
+        return self->entries[i].value;
+    }
+    self->misses++;
+    void* result = args ? FugaMethod_call(self->method, recv, args)
+                        : FugaMethod_callN(self->method, recv, argc, argv);
+    if (!Fuga_isRaised(result))
+        FugaMemo_insert(self, hash, recvKey, argc, keys, result);
+    return result;
+}
+
+void* FugaMemo_call(void* _self, void* recv, void* args)
+{
+    FugaMemo* self = _self;
+    FUGA_NEED(args);
+    FugaSlots* slots = FUGA_HEADER(args)->slots;
+    size_t argc = slots ? FugaSlots_length(slots) : 0;
+    void* argv[FUGA_MEMO_ARGC];
+    for (size_t i = 0; i < argc && i < FUGA_MEMO_ARGC; i++) {
+        argv[i] = FugaSlots_getByIndex(slots, i).value;
+        FUGA_NEED(argv[i]);
+    }
+    return FugaMemo_lookup(self, recv, argc, argv, args);
+}
+
+void* FugaMemo_strict(void* self, void* recv, size_t argc, void** argv)
+{
+    return FugaMemo_lookup(self, recv, argc, argv, NULL);
+}
+
+void* FugaMemo_stats(void* _self)
+{
+    FugaMemo* self = _self;
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (!FugaMemo_is(self))
+        FUGA_RAISE(FUGA->TypeError, "memoStats: expected a memo");
+    void* stats = Fuga_clone(FUGA->Object);
+    FUGA_CHECK(Fuga_setS(stats, "hits",      FUGA_INT(self->hits)));
+    FUGA_CHECK(Fuga_setS(stats, "misses",    FUGA_INT(self->misses)));
+    FUGA_CHECK(Fuga_setS(stats, "evictions", FUGA_INT(self->evictions)));
+    FUGA_CHECK(Fuga_setS(stats, "size",      FUGA_INT(self->size)));
+    FUGA_CHECK(Fuga_setS(stats, "capacity",  FUGA_INT(self->capacity)));
+    return stats;
+}
+
+void FugaMemo_sweep(void* self)
+{
+    ALWAYS(self);
+    for (FugaMemo* memo = FUGA->memos; memo; memo = memo->next) {
+        long i = memo->oldest;
+        while (i >= 0) {
+            FugaMemoEntry* entry = &memo->entries[i];
+            long newer = entry->newer;
+            if (entry->recv.object && !Fuga_isMarked(entry->recv.object)) {
+                FugaMemo_remove(memo, i);
+                i = newer;
+                continue;
+            }
+            for (size_t j = 0; j < entry->argc; j++) {
+                void* key = entry->keys[j].object;
+                if (key && !Fuga_isMarked(key)) {
+                    FugaMemo_remove(memo, i);
+                    break;
+                }
+            }
+            i = newer;
+        }
+    }
+}
+
+// The slot an arg of `memo` or `memoStats` names: `name` (found from
+// `scope`, and set in `_this`), or `owner name`. Otherwise, *name is
+// NULL, and the result is the value of the arg.
+static void* FugaMemo_target(void* self, void** owner, void** name)
+{
+    void* code  = Fuga_lazyCode(self);
+    void* scope = Fuga_lazyScope(self);
+    FUGA_CHECK(code); FUGA_CHECK(scope);
+    self = scope;
+    *name = NULL;
+    if (Fuga_isMsg(code) && !Fuga_length(code)) {
+        *owner = Fuga_getS(scope, "_this");
+        *name  = FugaMsg_name(code);
+        FUGA_CHECK(*owner); FUGA_CHECK(*name);
+        return Fuga_get(scope, *name);
+    }
+    if (Fuga_isExpr(code) && Fuga_length(code) > 1) {
+        void* last = Fuga_getI(code, -1);
+        if (Fuga_isMsg(last) && !Fuga_length(last)) {
+            void* path = Fuga_clone(FUGA->Expr);
+            FUGA_CHECK(Fuga_extend_(path, code));
+            FUGA_CHECK(Fuga_delI(path, -1));
+            *owner = Fuga_eval(path, scope, scope);
+            *name  = FugaMsg_name(last);
+            FUGA_CHECK(*owner); FUGA_CHECK(*name);
+            return Fuga_get(*owner, *name);
+        }
+    }
+    return Fuga_eval(code, scope, scope);
+}
+
+void* FugaMemo_memo(void* self, void* args)
+{
+    ALWAYS(self); ALWAYS(args);
+    args = Fuga_lazySlots(args);
+    FUGA_CHECK(args);
+    long length = Fuga_length(args);
+    if (length < 1 || length > 2)
+        FUGA_RAISE(FUGA->TypeError, "memo: expected 1 or 2 arguments");
+
+    long capacity = FUGA_MEMO_CAPACITY;
+    if (length == 2) {
+        void* arg = Fuga_need(Fuga_getI(args, 1));
+        FUGA_CHECK(arg);
+        if (!Fuga_isInt(arg))
+            FUGA_RAISE(FUGA->TypeError, "memo: expected an int capacity");
+        capacity = FugaInt_value(arg);
+    }
+
+    void *owner, *name;
+    void* method = FugaMemo_target(Fuga_getI(args, 0), &owner, &name);
+    FUGA_CHECK(method);
+    void* memo = FugaMemo_new(method, capacity);
+    FUGA_CHECK(memo);
+    if (!name)
+        return memo;
+    // A method named on its own is called on its own too, so its
+    // receiver is the calling scope, which is never the same twice.
+    if (memo != method && Fuga_isMsg(Fuga_lazyCode(Fuga_getI(args, 0))))
+        ((FugaMemo*)memo)->byRecv = false;
+    FUGA_CHECK(Fuga_set(owner, name, memo));
+    return FUGA->nil;
+}
+
+void* FugaMemo_memoStats(void* self, void* args)
+{
+    ALWAYS(self); ALWAYS(args);
+    args = Fuga_lazySlots(args);
+    FUGA_CHECK(args);
+    if (!Fuga_hasLength_(args, 1))
+        FUGA_RAISE(FUGA->TypeError, "memoStats: expected 1 argument");
+    void *owner, *name;
+    void* memo = FugaMemo_target(Fuga_getI(args, 0), &owner, &name);
+    FUGA_CHECK(memo);
+    return FugaMemo_stats(memo);
+}
+
+#ifdef TESTING
+TESTS(FugaMemo_new) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "fib(n) { if(n < 2, n, fib(n - 1) + fib(n - 2)) }\n"
+        "memo(fib)\n"
+        "a = fib(30)\n"
+        "b = fib(30)\n"
+        "name(s) { s }\n"
+        "memo(name, 2)\n"
+        "name(\"x\"), name(\"x\"), name(\"y\"), name(\"z\"), name(\"x\")\n"
+        "Acct = (rate = 2)\n"
+        "Acct scaled(n) { self rate * n }\n"
+        "memo(Acct scaled)\n"
+        "acct = Acct clone\n"
+        "acct rate = 10\n"
+        "x = Acct scaled(3)\n"
+        "y = acct scaled(3)\n"
+        "z = Acct scaled(3)\n"
+    );
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "_this", scope)));
+    TEST(!Fuga_isRaised(FugaCode_evalIn(code, scope)));
+    TEST(FugaInt_is_(Fuga_getS(scope, "a"), 832040));
+    TEST(FugaInt_is_(Fuga_getS(scope, "b"), 832040));
+    TEST(FugaInt_is_(Fuga_getS(scope, "x"), 6));
+    TEST(FugaInt_is_(Fuga_getS(scope, "y"), 30));
+    TEST(FugaInt_is_(Fuga_getS(scope, "z"), 6));
+
+    void* stats = FugaMemo_stats(Fuga_getS(scope, "fib"));
+    TEST(FugaInt_is_(Fuga_getS(stats, "misses"), 31));
+    TEST(FugaInt_is_(Fuga_getS(stats, "hits"), 29));
+    TEST(FugaInt_is_(Fuga_getS(stats, "evictions"), 0));
+    stats = FugaMemo_stats(Fuga_getS(scope, "name"));
+    TEST(FugaInt_is_(Fuga_getS(stats, "hits"), 1));
+    TEST(FugaInt_is_(Fuga_getS(stats, "misses"), 4));
+    TEST(FugaInt_is_(Fuga_getS(stats, "evictions"), 2));
+    TEST(FugaInt_is_(Fuga_getS(stats, "size"), 2));
+    stats = FugaMemo_stats(Fuga_getS(Fuga_getS(scope, "Acct"), "scaled"));
+    TEST(FugaInt_is_(Fuga_getS(stats, "hits"), 1));
+    TEST(FugaInt_is_(Fuga_getS(stats, "misses"), 2));
+    TEST(Fuga_isRaised(FugaMemo_stats(FUGA->Object)));
+    TEST(Fuga_isRaised(FugaMemo_new(FUGA->Int, 10)));
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaMemo_sweep) {
+    void* self = Fuga_init();
+    void* root = Fuga_clone(FUGA->Object);
+    Fuga_root(root);
+    void* formals = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(formals, FUGA_MSG("x"))));
+    void* method = FugaMethod_method(FUGA->Prelude, formals, FUGA_INT(1));
+    FugaMemo* memo = FugaMemo_new(method, 8);
+    TEST(!Fuga_isRaised(memo));
+    TEST(!Fuga_isRaised(Fuga_setS(root, "memo", memo)));
+
+    void* kept = Fuga_clone(FUGA->Object);
+    void* lost = Fuga_clone(FUGA->Object);
+    void* five = FUGA_INT(5);
+    TEST(!Fuga_isRaised(Fuga_setS(root, "kept", kept)));
+    TEST(FugaInt_is_(FugaMethod_callN(memo, root, 1, &kept), 1));
+    TEST(FugaInt_is_(FugaMethod_callN(memo, root, 1, &lost), 1));
+    TEST(FugaInt_is_(FugaMethod_callN(memo, root, 1, &five), 1));
+    TEST(FugaInt_is_(FugaMethod_callN(memo, lost, 1, &kept), 1));
+    TEST(memo->size == 4);
+
+    Fuga_collect(self);
+    TEST(memo->size == 2);
+    five = FUGA_INT(5);
+    TEST(FugaInt_is_(FugaMethod_callN(memo, root, 1, &kept), 1));
+    TEST(FugaInt_is_(FugaMethod_callN(memo, root, 1, &five), 1));
+    TEST(memo->hits == 2 && memo->misses == 4);
+
+    Fuga_quit(self);
+}
+#endif
+
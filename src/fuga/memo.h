@@ -0,0 +1,82 @@
+#ifndef FUGA_MEMO_H
+#define FUGA_MEMO_H
+
+#include "fuga.h"
+
+/**
+*** # FugaMemo
+***
+*** A memo is a method that remembers what another method returned. It's
+*** meant for pure methods, like `fib`, that are called again and again
+*** with the same args: the first call is made, and the calls after it
+*** are answered from a table. The args are always evaluated, so a memo of
+*** a method with lazy args (`~x`) forces them. Raised exceptions aren't
+*** remembered.
+***
+*** The receiver and args are compared by value for ints and strings, and
+*** by identity for everything else (symbols included). Calls with more
+*** than `FUGA_MEMO_ARGC` args are just passed on.
+***
+*** A memo holds at most `capacity` results, and forgets the one used
+*** least recently to make room for a new one. It doesn't keep its keys
+*** alive: when an object used as the receiver or an arg is collected, the
+*** results for it are forgotten too (see `FugaMemo_sweep`).
+***
+*** From Fuga, `memo(fib)` replaces `fib` (in `_this`, like `def`) with a
+*** memo of it, and `memo(fib, 100)` sets the capacity. Since `fib` is
+*** called on its own, with the calling scope as its receiver, that memo
+*** goes by the args alone. `memo(x y)`
+*** replaces the slot `y` of `x`, and `memo(method(...))` just returns
+*** the memo. `memoStats(fib)` says how a memo has done so far, with the
+*** slots `hits`, `misses`, `evictions`, `size` and `capacity`.
+***
+*** ### FUGA_MEMO_ARGC
+***
+*** The most args a call can have and be remembered.
+***
+*** ### FUGA_MEMO_CAPACITY
+***
+*** The number of results a memo holds unless it's given a capacity.
+**/
+#define FUGA_MEMO_ARGC 4
+
+#ifndef FUGA_MEMO_CAPACITY
+#define FUGA_MEMO_CAPACITY 1024
+#endif
+
+typedef struct FugaMemo FugaMemo;
+
+/**
+*** ### FugaMemo_new
+***
+*** Make a memo of `method` that holds up to `capacity` results.
+***
+*** ### FugaMemo_stats
+***
+*** The stats of a memo, as an object.
+**/
+void* FugaMemo_new(void* method, long capacity);
+void* FugaMemo_stats(void* self);
+
+/**
+*** ### FugaMemo_sweep
+***
+*** Forget every result whose args include an object that the collector
+*** hasn't marked. `Fuga_collect` calls this between marking and freeing.
+**/
+void FugaMemo_sweep(void* self);
+
+/**
+*** ### FugaMemo_memo
+***
+*** `memo`, with its args unevaluated.
+***
+*** ### FugaMemo_memoStats
+***
+*** `memoStats`, with its args unevaluated.
+**/
+void* FugaMemo_memo(void* self, void* args);
+void* FugaMemo_memoStats(void* self, void* args);
+
+#endif
+
@@ -1,4 +1,9 @@
 #include "method.h"
+#include "frame.h"
+#include "dispatch.h"
+#include "jit.h"
+#include "code.h"
+#include "parser.h"
 #include "test.h"
 
 const FugaType FugaMethod_type = {
@@ -17,8 +22,12 @@ void FugaMethod_init(void* self)
     Fuga_setS(FUGA->Method, "str",   FUGA_METHOD_STR(_FugaMethod_str));
 }
 
+// Every kind of method starts with these two: how to call it with an
+// args object, and, for strict methods, how to call it with its args
+// already evaluated into an array (see FugaMethod_callStrict).
 struct FugaMethod {
     void* (*method)(void*, void*, void*);
+    void* (*strict)(void*, void*, size_t, void**);
 };
 
 void* FugaMethod_new_(void* self, void* (*method)(void*, void*, void*))
@@ -36,13 +45,65 @@ void* FugaMethod_call(void* _self, void* recv, void* args)
     ALWAYS(self); ALWAYS(recv); ALWAYS(args);
     ALWAYS(Fuga_isMethod(self));
     FUGA_CHECK(recv); FUGA_CHECK(args);
-    return self->method(self, recv, args);
+    FUGA_ENTER;
+    void* result = self->method(self, recv, args);
+    FUGA_LEAVE;
+    return result;
+}
+
+bool FugaMethod_isStrict(void* _self)
+{
+    FugaMethod* self = _self;
+    ALWAYS(self);
+    return Fuga_isMethod(self) && self->strict;
+}
+
+void* FugaMethod_callStrict(void* _self, void* recv, size_t argc, void** argv)
+{
+    FugaMethod* self = _self;
+    ALWAYS(self); ALWAYS(recv);
+    ALWAYS(FugaMethod_isStrict(self));
+    FUGA_CHECK(recv);
+    FUGA_ENTER;
+    void* result = self->strict(self, recv, argc, argv);
+    FUGA_LEAVE;
+    return result;
+}
+
+void* FugaMethod_callN(void* _self, void* recv, size_t argc, void** argv)
+{
+    FugaMethod* self = _self;
+    ALWAYS(self); ALWAYS(recv);
+    ALWAYS(Fuga_isMethod(self));
+    if (self->strict)
+        return FugaMethod_callStrict(self, recv, argc, argv);
+    void* args = Fuga_clone(FUGA->Object);
+    FugaSlots_reserve(FUGA_HEADER(args)->slots, argc, 0);
+    for (size_t i = 0; i < argc; i++)
+        FUGA_CHECK(Fuga_append_(args, argv[i]));
+    return FugaMethod_call(self, recv, args);
+}
+
+// strict methods, called with an args object: evaluate the args, and
+// pass them on in an array.
+
+void* FugaMethodS_call(void* _self, void* recv, void* args)
+{
+    FugaMethod* self = _self;
+    FUGA_NEED(args);
+    FugaSlots* slots = FUGA_HEADER(args)->slots;
+    size_t argc = slots ? FugaSlots_length(slots) : 0;
+    void* argv[FUGA_METHOD_ARGC];
+    for (size_t i = 0; i < argc && i < FUGA_METHOD_ARGC; i++)
+        argv[i] = FugaSlots_getByIndex(slots, i).value;
+    return self->strict(self, recv, argc, argv);
 }
 
 // arg methods
 
 typedef struct {
     void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
     void* (*method) (void*, void*);
 } FugaMethodN;
 
@@ -62,18 +123,76 @@ void* FugaMethodN_new_(void* self, void* (*method)(void*, void*))
     return result;
 }
 
+// tail methods (control forms: they take their args unevaluated, as
+// code and a scope, and they can leave their last step to the caller
+// when they're called in tail position).
+
+typedef struct {
+    void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
+    void* (*method) (void*, void*, void*, bool);
+} FugaMethodT;
+
+void* FugaMethodT_call(void* _self, void* recv, void* args)
+{
+    FugaMethodT* self = _self;
+    void* scope;
+    void* code = Fuga_lazySplit(args, &scope);
+    FUGA_CHECK(code);
+    return self->method(recv, code, scope, false);
+}
+
+bool FugaMethod_isForm(void* _self)
+{
+    FugaMethod* self = _self;
+    ALWAYS(self);
+    return Fuga_isMethod(self) && self->method == FugaMethodT_call;
+}
+
+bool FugaMethodT_is_(void* _self, FugaMethodFnT method)
+{
+    FugaMethodT* self = _self;
+    return self && FugaMethod_isForm(self) && self->method == method;
+}
+
+void* FugaMethod_callForm(
+    void* _self,
+    void* recv,
+    void* code,
+    void* scope,
+    bool tail
+) {
+    FugaMethodT* self = _self;
+    ALWAYS(self); ALWAYS(recv); ALWAYS(code); ALWAYS(scope);
+    ALWAYS(FugaMethod_isForm(self));
+    FUGA_CHECK(recv); FUGA_CHECK(code);
+    FUGA_ENTER;
+    void* result = self->method(recv, code, scope, tail);
+    FUGA_LEAVE;
+    return result;
+}
+
+void* FugaMethodT_new_(void* self, FugaMethodFnT method)
+{
+    FugaMethodT* result = Fuga_clone_(FUGA->Method, sizeof(FugaMethodT));
+    Fuga_type_(result, &FugaMethod_type);
+    result->call   = FugaMethodT_call;
+    result->method = method;
+    return result;
+}
+
 // str method
 
 typedef struct {
     void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
     void* (*method) (void*);
 } FugaMethodStr;
 
-void* FugaMethodStr_call(void* _self, void* recv, void* args)
+void* FugaMethodStr_strict(void* _self, void* recv, size_t argc, void** argv)
 {
     FugaMethodStr* self = _self;
-    FUGA_NEED(args);
-    if (!Fuga_hasLength_(args, 0))
+    if (argc != 0)
         FUGA_RAISE(FUGA->TypeError, "str: expected no arguments");
     if (Fuga_isTrue(Fuga_hasRawS(recv, "_name")))
         return Fuga_getRawS(recv, "_name");
@@ -98,7 +217,8 @@ void* FugaMethodStr_new_(void* self, void* (*method)(void*))
 {
     FugaMethodStr* result = Fuga_clone_(FUGA->Method, sizeof(*result));
     Fuga_type_(result, &FugaMethod_type);
-    result->call   = FugaMethodStr_call;
+    result->call   = FugaMethodS_call;
+    result->strict = FugaMethodStr_strict;
     result->method = method;
     return result;
 }
@@ -107,14 +227,14 @@ void* FugaMethodStr_new_(void* self, void* (*method)(void*))
 
 typedef struct {
     void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
     void* (*method) (void*);
 } FugaMethod0;
 
-void* FugaMethod0_call(void* _self, void* recv, void* args)
+void* FugaMethod0_strict(void* _self, void* recv, size_t argc, void** argv)
 {
     FugaMethod0* self = _self;
-    FUGA_NEED(args);
-    if (!Fuga_hasLength_(args, 0))
+    if (argc != 0)
         FUGA_RAISE(FUGA->TypeError, "expected no arguments");
     return self->method(recv);
 }
@@ -123,7 +243,8 @@ void* FugaMethod0_new_(void* self, void* (*method)(void*))
 {
     FugaMethod0* result = Fuga_clone_(FUGA->Method, sizeof(*result));
     Fuga_type_(result, &FugaMethod_type);
-    result->call   = FugaMethod0_call;
+    result->call   = FugaMethodS_call;
+    result->strict = FugaMethod0_strict;
     result->method = method;
     return result;
 }
@@ -131,29 +252,204 @@ void* FugaMethod0_new_(void* self, void* (*method)(void*))
 // op method (i.e., converts +(a,b) into a +(b), or +(a) into a \+).
 
 typedef struct {
-    void* (*call) (void*, void*, void*);
+    void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
     void* op;
+    FugaIntOp intOp;        // what Int's method for op was...
+    size_t    intWrites;    // ... when Int's slots had this many writes
 } FugaMethodOp;
 
 void* FugaMethodOp_call(void* _self, void* recv, void* args)
 {
     FugaMethodOp* self = _self;
-    args = Fuga_lazySlots(args);
-    FUGA_CHECK(self); FUGA_CHECK(recv); FUGA_NEED(args);
-    if (Fuga_hasLength_(args, 1)) {
-        FUGA_CHECK(recv = Fuga_getI(args, 0));
-        FUGA_CHECK(args = Fuga_clone(FUGA->Object));
-        return Fuga_send(recv, self->op, args);
-    } else if (Fuga_hasLength_(args, 2)) {
-        void* arg;
-        FUGA_CHECK(recv = Fuga_getI(args, 0));
-        FUGA_CHECK(arg  = Fuga_getI(args, 1));
-        FUGA_CHECK(args = Fuga_clone(FUGA->Object));
-        FUGA_CHECK(Fuga_append_(args, arg));
-        return Fuga_send(recv, self->op, args);
-    } else {
+    FUGA_CHECK(self); FUGA_CHECK(recv);
+    void* argv[2];
+    size_t argc;
+    void* error = Fuga_lazyArgs(args, &argc, argv, 2);
+    if (error)
+        return error;
+    if (argc != 1 && argc != 2)
         FUGA_RAISE(FUGA->TypeError, "op expected 1 or 2 arguments");
+    return Fuga_sendN(argv[0], self->op, argc-1, argv+1);
+}
+
+// What a fold of `msg` depends on, besides its operator: it's made again
+// once Int's or String's slots, or the msg's args, are written to.
+static size_t FugaMethodOp_version(void* self)
+{
+    return FugaSlots_writes(FUGA_HEADER(FUGA->Int)->slots)
+         + FugaSlots_writes(FUGA_HEADER(FUGA->String)->slots)
+         + FugaSlots_writes(FUGA_HEADER(self)->slots);
+}
+
+// Is this an int or a string that nothing has been added to?
+static bool FugaMethodOp_isPlain(void* self)
+{
+    void* proto = FUGA_HEADER(self)->proto;
+    return !FUGA_HEADER(self)->slots
+        && ((Fuga_isInt(self) && proto == FUGA->Int)
+         || (Fuga_isString(self) && proto == FUGA->String));
+}
+
+static void* FugaMethodOp_folded(void* self, FugaMsg* msg, void* scope);
+
+// The constant an operand stands for in `scope`: itself, if it's a plain
+// literal, or what it was folded to, if it's an operator msg whose fold
+// still holds. NULL if it isn't constant.
+static void* FugaMethodOp_constant(void* self, void* scope)
+{
+    if (FugaMethodOp_isPlain(self))
+        return self;
+    FugaMsg* msg = self;
+    if (!Fuga_isMsg(msg) || !msg->folded)
+        return NULL;
+    void* op = Fuga_get(scope, msg->name);
+    if (Fuga_isRaised(op))
+        return NULL;
+    return FugaMethodOp_folded(op, msg, scope);
+}
+
+// What `msg`, sent in `scope` and resolved to the op method `self`, was
+// folded to, if that still holds.
+static void* FugaMethodOp_folded(void* self, FugaMsg* msg, void* scope)
+{
+    void* folded = msg->folded;
+    if (!folded || msg->foldOp != self
+        || msg->foldVersion != FugaMethodOp_version(msg)
+        || ((Fuga_isInt(folded) || Fuga_isString(folded))
+            && !FugaMethodOp_isPlain(folded)))
+        return NULL;
+    FugaSlots* slots = FUGA_HEADER(msg)->slots;
+    for (long i = 0; i < 2; i++)
+        if (!FugaMethodOp_constant(FugaSlots_getByIndex(slots, i).value,
+                                   scope))
+            return NULL;
+    return folded;
+}
+
+// Keep the value of `msg`, a primitive operation, if its operands are
+// constants. Every later send gives the same value, so it's frozen (see
+// Fuga_freeze): only plain ints and strings, which can be, and the
+// booleans and nil, which are shared anyway, are kept.
+static void* FugaMethodOp_fold(
+    void* self,
+    FugaMsg* msg,
+    void* scope,
+    void* result
+) {
+    if (!FUGA_FOLD || Fuga_isRaised(result))
+        return result;
+    if (result != FUGA->True && result != FUGA->False
+                             && result != FUGA->nil
+                             && !FugaMethodOp_isPlain(result))
+        return result;
+    FugaSlots* slots = FUGA_HEADER(msg)->slots;
+    for (long i = 0; i < 2; i++)
+        if (!FugaMethodOp_constant(FugaSlots_getByIndex(slots, i).value,
+                                   scope))
+            return result;
+    if (FugaMethodOp_isPlain(result))
+        Fuga_freeze(result);
+    msg->folded      = result;
+    msg->foldOp      = self;
+    msg->foldVersion = FugaMethodOp_version(msg);
+    return result;
+}
+
+// Send an operator msg, `op(a, b)`, that resolved to this op method
+// straight to `a`, without thunks or args objects, and with the right
+// operand only evaluated up front if the method it goes to is strict.
+// When both sides are ints, and Int's method for `op` is still the one
+// it started out with, skip the send altogether. Returns NULL if `value`
+// isn't an op method, or the msg is one the op method should handle.
+void* FugaMethodOp_send(void* value, void* _msg, void* scope)
+{
+    FugaMethodOp* self = value;
+    FugaMsg* msg = _msg;
+    if (!Fuga_isMethod(self) || self->call != FugaMethodOp_call)
+        return NULL;
+    FugaSlots* slots = FUGA_HEADER(msg)->slots;
+    if (!slots || FugaSlots_length(slots) != 2)
+        return NULL;
+    void* folded = FugaMethodOp_folded(self, msg, scope);
+    if (folded)
+        return folded;
+    void* left  = FugaSlots_getByIndex(slots, 0).value;
+    void* right = FugaSlots_getByIndex(slots, 1).value;
+    if (FugaMsg_is_(left, "~") || FugaMsg_is_(right, "~"))
+        return NULL;
+
+    void* recv = Fuga_eval(left, scope, scope);
+    FUGA_NEED(recv);
+    return FugaMethodOp_sendFrom(self, msg, scope, recv);
+}
+
+bool FugaMethodOp_fuses(void* _self, void* recv)
+{
+    FugaMethodOp* self = _self;
+    if (!Fuga_isMethod(self) || self->call != FugaMethodOp_call)
+        return false;
+    size_t writes = FugaSlots_writes(FUGA_HEADER(FUGA->Int)->slots);
+    if (self->intWrites != writes) {
+        self->intOp     = FugaInt_op(self, self->op);
+        self->intWrites = writes;
     }
+    return self->intOp && Fuga_isInt(recv) && !FUGA_HEADER(recv)->slots
+                       && FUGA_HEADER(recv)->proto == FUGA->Int;
+}
+
+void* FugaMethodOp_fuse(void* _self, void* recv, void* arg)
+{
+    FugaMethodOp* self = _self;
+    ALWAYS(FugaMethodOp_fuses(self, recv));
+    if (Fuga_isInt(arg))
+        return FugaInt_fused(self->intOp, recv, arg);
+    return Fuga_sendN(recv, self->op, 1, &arg);
+}
+
+void* FugaMethodOp_sendFrom(void* value, void* _msg, void* scope, void* recv)
+{
+    FugaMethodOp* self = value;
+    FugaMsg* msg = _msg;
+    void* right = FugaSlots_getByIndex(FUGA_HEADER(msg)->slots, 1).value;
+    if (FugaMethodOp_fuses(self, recv)) {
+        void* arg = Fuga_eval(right, scope, scope);
+        FUGA_NEED(arg);
+        void* result = FugaMethodOp_fuse(self, recv, arg);
+        return Fuga_isInt(arg) ? FugaMethodOp_fold(self, msg, scope, result)
+                               : result;
+    }
+
+    void* method = Fuga_get(recv, self->op);
+    FUGA_NEED(method);
+    if (!Fuga_isMethod(method))
+        FUGA_RAISE(FUGA->TypeError,
+            "attempt to call a non-method with arguments"
+        );
+    void* arg;
+    if (FugaMethod_isStrict(method)) {
+        arg = Fuga_eval(right, scope, scope);
+        FUGA_NEED(arg);
+        void* result = FugaMethod_callStrict(method, recv, 1, &arg);
+        if (Fuga_isString(recv) && Fuga_isString(arg)
+            && FugaMethod1_is_(method, (FugaMethodFn1)FugaString_cat_))
+            return FugaMethodOp_fold(self, msg, scope, result);
+        return result;
+    }
+    if (Fuga_isInt(right) || Fuga_isString(right) || Fuga_isSymbol(right))
+        arg = right;
+    else
+        arg = Fuga_lazy_(right, scope);
+    return FugaMethod_callN(method, recv, 1, &arg);
+}
+
+// The operator an op method sends, or NULL if `self` isn't one.
+void* FugaMethodOp_op(void* _self)
+{
+    FugaMethodOp* self = _self;
+    if (!Fuga_isMethod(self) || self->call != FugaMethodOp_call)
+        return NULL;
+    return self->op;
 }
 
 void FugaMethodOp_mark(void* _self) {
@@ -167,6 +463,7 @@ void* FugaMethodOp_new_(void* self, const char* name)
     Fuga_type_(result, &FugaMethod_type);
     result->call = FugaMethodOp_call;
     result->op   = FUGA_SYMBOL(name);
+    result->intWrites = (size_t)-1;
     Fuga_onMark_(result, FugaMethodOp_mark);
     return result;
 }
@@ -175,24 +472,31 @@ void* FugaMethodOp_new_(void* self, const char* name)
 
 typedef struct {
     void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
     void* (*method) (void*, void*);
 } FugaMethod1;
 
-void* FugaMethod1_call(void* _self, void* recv, void* args)
+void* FugaMethod1_strict(void* _self, void* recv, size_t argc, void** argv)
 {
     FugaMethod1* self = _self;
-    FUGA_NEED(args);
-    if (!Fuga_hasLength_(args, 1))
+    if (argc != 1)
         FUGA_RAISE(FUGA->TypeError, "expected 1 argument");
-    void* arg0 = Fuga_getI(args, 0);
-    return self->method(recv, arg0);
+    return self->method(recv, argv[0]);
+}
+
+bool FugaMethod1_is_(void* _self, FugaMethodFn1 method)
+{
+    FugaMethod1* self = _self;
+    return self && Fuga_isMethod(self)
+        && self->strict == FugaMethod1_strict && self->method == method;
 }
 
 void* FugaMethod1_new_(void* self, void* (*method)(void*, void*))
 {
     FugaMethod1* result = Fuga_clone_(FUGA->Method, sizeof(*result));
     Fuga_type_(result, &FugaMethod_type);
-    result->call   = FugaMethod1_call;
+    result->call   = FugaMethodS_call;
+    result->strict = FugaMethod1_strict;
     result->method = method;
     return result;
 }
@@ -201,25 +505,57 @@ void* FugaMethod1_new_(void* self, void* (*method)(void*, void*))
 
 typedef struct {
     void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
     void* (*method) (void*, void*, void*);
 } FugaMethod2;
 
-void* FugaMethod2_call(void* _self, void* recv, void* args)
+void* FugaMethod2_strict(void* _self, void* recv, size_t argc, void** argv)
 {
     FugaMethod2* self = _self;
-    FUGA_NEED(args);
-    if (!Fuga_hasLength_(args, 2))
+    if (argc != 2)
         FUGA_RAISE(FUGA->TypeError, "expected 2 arguments");
-    void* arg0 = Fuga_getI(args, 0);
-    void* arg1 = Fuga_getI(args, 1);
-    return self->method(recv, arg0, arg1);
+    return self->method(recv, argv[0], argv[1]);
 }
 
 void* FugaMethod2_new_(void* self, void* (*method)(void*, void*, void*))
 {
     FugaMethod2* result = Fuga_clone_(FUGA->Method, sizeof(*result));
     Fuga_type_(result, &FugaMethod_type);
-    result->call   = FugaMethod2_call;
+    result->call   = FugaMethodS_call;
+    result->strict = FugaMethod2_strict;
+    result->method = method;
+    return result;
+}
+
+// variadic strict methods (up to FUGA_METHOD_ARGC args)
+
+typedef struct {
+    void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
+    void* (*method) (void*, size_t, void**);
+} FugaMethodV;
+
+void* FugaMethodV_strict(void* _self, void* recv, size_t argc, void** argv)
+{
+    FugaMethodV* self = _self;
+    if (argc > FUGA_METHOD_ARGC)
+        FUGA_RAISE(FUGA->TypeError, "too many arguments");
+    return self->method(recv, argc, argv);
+}
+
+bool FugaMethodV_is_(void* _self, FugaMethodFnV method)
+{
+    FugaMethodV* self = _self;
+    return self && Fuga_isMethod(self)
+        && self->strict == FugaMethodV_strict && self->method == method;
+}
+
+void* FugaMethodV_new_(void* self, void* (*method)(void*, size_t, void**))
+{
+    FugaMethodV* result = Fuga_clone_(FUGA->Method, sizeof(*result));
+    Fuga_type_(result, &FugaMethod_type);
+    result->call   = FugaMethodS_call;
+    result->strict = FugaMethodV_strict;
     result->method = method;
     return result;
 }
@@ -228,8 +564,27 @@ void* FugaMethod2_new_(void* self, void* (*method)(void*, void*, void*))
 
 typedef struct {
     void* (*call)   (void*, void*, void*);
+    void* (*strict) (void*, void*, size_t, void**);
+    FugaDispatch* dispatch;     // made for these patterns...
+    void*         patterns;
+    size_t        version;      // ... at this FugaDispatch_version
+    FugaJit*      jit;          // compiled code, if any
+    long          calls;        // calls made until it was compiled
 } FugaMethodFuga;
 
+void FugaMethodFuga_free(void* _self)
+{
+    FugaMethodFuga* self = _self;
+    FugaDispatch_free(self->dispatch);
+    FugaJit_free(self->jit);
+}
+
+void FugaMethodFuga_mark(void* _self)
+{
+    FugaMethodFuga* self = _self;
+    FugaJit_mark(self, self->jit);
+}
+
 void* FugaMethodFuga_scope(void* self)
 {
     return Fuga_getS(self, "scope");
@@ -245,44 +600,188 @@ void* FugaMethodFuga_body(void* self)
     return Fuga_getS(self, "body");
 }
 
-void* FugaMethodFuga_call(void* self, void* recv, void* args)
+// Make the frame of a call by sending `match` to the formals.
+static void* FugaMethodFuga_match(
+    void* scope,
+    void* formals,
+    void* recv,
+    void* args
+) {
+    void* match = Fuga_match_(formals, args);
+    FUGA_CHECK(match);
+    void* frame = FugaFrame_new(scope);
+    FUGA_CHECK(frame);
+    FUGA_CHECK(Fuga_setS(frame, "self", recv));
+    FUGA_CHECK(Fuga_update_(frame, match));
+    return frame;
+}
+
+// Make the frame of a call with the given pattern. Returns NULL if the
+// pattern doesn't match.
+static void* FugaMethodFuga_try(
+    void* self,
+    void* formals,
+    void* recv,
+    void* args
+) {
+    void* frame = FugaFrame_binds(formals)
+                ? FugaFrame_bind(self, formals, recv, args)
+                : FugaMethodFuga_match(self, formals, recv, args);
+    if (!frame)
+        return NULL;
+    FUGA_TRY(frame) {
+        FUGA_CATCH_NO_MATCH
+            return NULL;
+        FUGA_RERAISE;
+    }
+    return frame;
+}
+
+// The dispatch table for the patterns, made again if they (or the
+// primitive matchers) have changed since the last call. NULL if the
+// patterns can't have one.
+static FugaDispatch* FugaMethodFuga_dispatch(void* _self, void* patterns)
 {
+    FugaMethodFuga* self = _self;
+    if (Fuga_length(patterns) < 2)
+        return NULL;
+    size_t version = FugaDispatch_version(self, patterns);
+    if (self->patterns != patterns || self->version != version) {
+        FugaDispatch_free(self->dispatch);
+        self->dispatch = FugaDispatch_new(self, patterns);
+        self->patterns = patterns;
+        self->version  = version;
+    }
+    return self->dispatch;
+}
+
+// Compile the method once it's been called FUGA_JIT_CALLS times (or again,
+// once what it was compiled against changes), and run the compiled code
+// in `frame`. NULL if the call has to be interpreted.
+static void* FugaMethodFuga_jit(void* _self, void* frame)
+{
+    FugaMethodFuga* self = _self;
+    if (self->jit && !FugaJit_holds(self->jit, self)) {
+        FugaJit_free(self->jit);
+        self->jit   = NULL;
+        self->calls = 0;
+    }
+    if (!self->jit) {
+        if (self->calls > FUGA_JIT_CALLS || ++self->calls <= FUGA_JIT_CALLS)
+            return NULL;
+        self->jit = FugaJit_new(self);
+        if (!self->jit)
+            return NULL;
+    }
+    return FugaJit_call(self->jit, frame);
+}
+
+// Find the pattern that matches and evaluate its body, in tail position,
+// in a frame that belongs to `call`.
+static void* FugaMethodFuga_enter(
+    void* self,
+    void* recv,
+    void* args,
+    size_t call
+) {
     FUGA_CHECK(self); FUGA_CHECK(recv); FUGA_CHECK(args);
     void* scope   = FugaMethodFuga_scope (self);
     void* argss   = FugaMethodFuga_args  (self);
     void* bodys   = FugaMethodFuga_body  (self);
     FUGA_CHECK(scope); FUGA_CHECK(bodys); FUGA_CHECK(argss);
     ALWAYS(Fuga_isMethod(self));
-    FUGA_CHECK(scope = Fuga_clone(scope));
-    FUGA_CHECK(Fuga_setS(scope, "self", recv));
-
-    FUGA_FOR(i, formals, argss) {
-        void* match = Fuga_match_(formals, args);
-        FUGA_TRY(match) {
-            match = NULL;
-            FUGA_CATCH(FUGA->MatchError)
-                break; 
-            FUGA_RERAISE;
-        }
-        if (match) {
+
+    // With a dispatch table, the args are evaluated up front (the first
+    // pattern would evaluate them anyway), and only the patterns that
+    // could match them are tried.
+    const long* patterns = NULL;
+    FugaDispatch* dispatch = FugaMethodFuga_dispatch(self, argss);
+    if (dispatch) {
+        FUGA_NEED(args);
+        patterns = FugaDispatch_find(dispatch, args);
+    }
+    long length = Fuga_length(argss);
+    for (long n = 0; patterns ? patterns[n] >= 0 : n < length; n++) {
+        long i = patterns ? patterns[n] : n;
+        void* frame = FugaMethodFuga_try(scope, Fuga_getI(argss, i),
+                                         recv, args);
+        if (frame) {
+            FUGA_CHECK(frame);
+            FugaFrame_call_(frame, call);
+            if (FUGA->jit && length == 1) {
+                void* result = FugaMethodFuga_jit(self, frame);
+                if (result)
+                    return result;
+            }
             void* body = Fuga_getI(bodys, i);
             FUGA_CHECK(body);
-            FUGA_CHECK(Fuga_update_(scope, match));
-            return Fuga_eval(body, scope, scope);
+            return FugaCode_evalTail(body, frame, frame);
         }
     }
 
     FUGA_RAISE(FUGA->TypeError, "no patterns match");
 }
 
+// Calls in tail position come back here rather than nesting: this is the
+// trampoline that makes them. So is a `return` from any of their frames.
+// A `break` or `continue` from one of them that no loop of the call's
+// stopped is an error here, rather than something for the caller's loops.
+void* FugaMethodFuga_call(void* self, void* recv, void* args)
+{
+    size_t call = ++FUGA->calls;
+    void* result = FugaMethodFuga_enter(self, recv, args, call);
+    while (result == FUGA->Tail) {
+        FugaTail tail = FUGA->tail;
+        FUGA->tail = (FugaTail){.method = NULL};
+        if (tail.method)
+            result = FugaMethodFuga_enter(tail.method, tail.recv, tail.args,
+                                          call);
+        else
+            result = FugaCode_evalTail(tail.code, tail.scope, tail.scope);
+    }
+    if (FUGA->unwind.call != call)
+        return result;
+    if (result == Fuga_raise(FUGA->Return)) {
+        result = FUGA->unwind.value;
+        FUGA->unwind = (FugaUnwind){.value = NULL};
+    } else if (result == Fuga_raise(FUGA->Break)
+            || result == Fuga_raise(FUGA->Continue)) {
+        result = Fuga_raise(Fuga_clone(Fuga_catch(result)));
+        FUGA->unwind = (FugaUnwind){.value = NULL};
+    }
+    return result;
+}
+
+void* FugaMethod_tail(void* _self, void* recv, void* args)
+{
+    FugaMethod* self = _self;
+    ALWAYS(self); ALWAYS(recv); ALWAYS(args);
+    ALWAYS(Fuga_isMethod(self));
+    FUGA_CHECK(recv); FUGA_CHECK(args);
+    if (self->method == FugaMethodFuga_call) {
+        FUGA->tail = (FugaTail){.method = self, .recv = recv, .args = args};
+        return FUGA->Tail;
+    }
+    if (self->method == FugaMethodT_call) {
+        void* scope;
+        void* code = Fuga_lazySplit(args, &scope);
+        FUGA_CHECK(code);
+        return ((FugaMethodT*)self)->method(recv, code, scope, true);
+    }
+    return self->method(self, recv, args);
+}
+
 void* FugaMethod_method(void* self, void* args, void* body)
 {
     FUGA_NEED(self);
     FUGA_NEED(args);
     FUGA_NEED(body);
+    FugaFrame_resolve(self, args, body);
     FugaMethodFuga* result = Fuga_clone_(FUGA->Method, sizeof *result);
     Fuga_type_(result, &FugaMethod_type);
     result->call = FugaMethodFuga_call;
+    Fuga_onMark_(result, FugaMethodFuga_mark);
+    Fuga_onFree_(result, FugaMethodFuga_free);
     void* argss = Fuga_clone(FUGA->Object); Fuga_append_(argss, args);
     void* bodys = Fuga_clone(FUGA->Object); Fuga_append_(bodys, body);
     FUGA_CHECK(Fuga_setS(result, "scope", self));
@@ -298,6 +797,7 @@ void* FugaMethod_addPattern(void* self, void* args, void* body)
     FUGA_NEED(body);
     FUGA_IF(Fuga_hasS(self, "args")) {
         FUGA_IF(Fuga_hasS(self, "body")) {
+            FugaFrame_resolve(FugaMethodFuga_scope(self), args, body);
             FUGA_CHECK(Fuga_append_(Fuga_getS(self, "args"), args));
             FUGA_CHECK(Fuga_append_(Fuga_getS(self, "body"), body));
             return FUGA->nil;
@@ -308,3 +808,59 @@ void* FugaMethod_addPattern(void* self, void* args, void* body)
     );
 }
 
+#ifdef TESTING
+TESTS(FugaMethodOp_send) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser, "60 * 60 * 24, \"a\" ++ \"b\", 1 + x");
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "x", FUGA_INT(2))));
+    void* day = Fuga_getI(code, 0);
+    void* ab  = Fuga_getI(code, 1);
+    void* inc = Fuga_getI(code, 2);
+
+    // folded the first time, and the same value after that.
+    void* value = Fuga_eval(day, scope, scope);
+    TEST(FugaInt_is_(value, 86400));
+    TEST(Fuga_eval(day, scope, scope) == value);
+    value = Fuga_eval(ab, scope, scope);
+    TEST(FugaString_is_(value, "ab"));
+    TEST(Fuga_eval(ab, scope, scope) == value);
+    value = Fuga_eval(inc, scope, scope);
+    TEST(FugaInt_is_(value, 3));
+    TEST(Fuga_eval(inc, scope, scope) != value);
+
+    // what's kept can't be changed by one evaluation under the next.
+    FugaParser_readCode_(parser,
+        "f = method((), 60 * 60)\n"
+        "g = method((), \"a\" ++ \"b\")\n"
+        "a = f(), b = f(), c = g(), d = g()\n"
+        "try(a foo = 1, TypeError, nil)\n"
+        "try(c foo = 1, TypeError, nil)\n"
+    );
+    code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    void* mutable = Fuga_clone(scope);
+    TEST(!Fuga_isRaised(Fuga_setS(mutable, "_this", mutable)));
+    TEST(!Fuga_isRaised(FugaCode_evalIn(code, mutable)));
+    TEST(FugaInt_is_(Fuga_getS(mutable, "b"), 3600));
+    TEST(FugaString_is_(Fuga_getS(mutable, "d"), "ab"));
+    TEST(Fuga_isFalse(Fuga_hasS(Fuga_getS(mutable, "b"), "foo")));
+    TEST(Fuga_isFalse(Fuga_hasS(Fuga_getS(mutable, "d"), "foo")));
+
+    // not where the operator means something else.
+    void* other = Fuga_clone(scope);
+    TEST(!Fuga_isRaised(Fuga_setS(other, "*", FUGA_METHOD_OP("+"))));
+    TEST(FugaInt_is_(Fuga_eval(day, other, other), 144));
+    TEST(FugaInt_is_(Fuga_eval(day, scope, scope), 86400));
+
+    // nor once Int's method is replaced.
+    void* add = Fuga_getS(FUGA->Int, "+");
+    TEST(!Fuga_isRaised(Fuga_setS(FUGA->Int, "*", add)));
+    TEST(FugaInt_is_(Fuga_eval(day, scope, scope), 144));
+
+    Fuga_quit(self);
+}
+#endif
@@ -10,22 +10,75 @@ typedef void* (*FugaMethodFnN)   (void*, void*);
 typedef void* (*FugaMethodFn0)   (void*);
 typedef void* (*FugaMethodFn1)   (void*, void*);
 typedef void* (*FugaMethodFn2)   (void*, void*, void*);
+typedef void* (*FugaMethodFnV)   (void*, size_t, void**);
+typedef void* (*FugaMethodFnT)   (void*, void*, void*, bool);
+
+// Strict methods (FUGA_METHOD_0, _1, _2, _V and _STR) need all their
+// args evaluated before they do anything, so callers may evaluate the
+// args themselves, into an array, and skip making an args object. No
+// strict method takes more than FUGA_METHOD_ARGC args.
+//
+// FugaMethod_callN calls any method with its args in an array, and only
+// makes an args object for methods that aren't strict.
+#define FUGA_METHOD_ARGC 2
+
+// Tail methods (FUGA_METHOD_TAIL) are control forms like `if`: they get
+// the code of their args and the scope to evaluate it in, and evaluate
+// only what they need, with Fuga_needIn. (The scope is NULL when the
+// args have been evaluated already.) FugaMethod_callForm calls them
+// straight from a msg, without a thunk for the args.
 
 void* FugaMethod_new_(void* self, FugaMethodFn);
 void* FugaMethodN_new_(void* self, FugaMethodFnN);
+void* FugaMethodT_new_(void* self, FugaMethodFnT);
 void* FugaMethod0_new_(void* self, FugaMethodFn0);
 void* FugaMethod1_new_(void* self, FugaMethodFn1);
 void* FugaMethod2_new_(void* self, FugaMethodFn2);
+void* FugaMethodV_new_(void* self, FugaMethodFnV);
 void* FugaMethodStr_new_(void* self, FugaMethodFn0);
 void* FugaMethodOp_new_(void* self, const char* name);
 void* FugaMethod_method(void* scope, void* args, void* body);
 void* FugaMethod_addPattern(void* scope, void* args, void* body);
 void* FugaMethod_call(void* self, void* recv, void* args);
+void* FugaMethod_tail(void* self, void* recv, void* args);
+bool  FugaMethod1_is_(void* self, FugaMethodFn1);
+bool  FugaMethodV_is_(void* self, FugaMethodFnV);
+bool  FugaMethodT_is_(void* self, FugaMethodFnT);
+bool  FugaMethod_isStrict(void* self);
+bool  FugaMethod_isForm(void* self);
+void* FugaMethod_callForm(void* self, void* recv, void* code, void* scope,
+                          bool tail);
+void* FugaMethod_callStrict(void* self, void* recv, size_t argc, void** argv);
+void* FugaMethod_callN(void* self, void* recv, size_t argc, void** argv);
+void* FugaMethodOp_send(void* value, void* msg, void* scope);
+void* FugaMethodOp_op(void* self);
+
+// FugaMethodOp_send, once the left operand has been evaluated. An op
+// method `fuses` with an int it can skip the send for (see FugaInt_op);
+// then the right operand may be evaluated up front, and `fuse` gives the
+// result.
+void* FugaMethodOp_sendFrom(void* value, void* msg, void* scope, void* recv);
+bool  FugaMethodOp_fuses(void* value, void* recv);
+void* FugaMethodOp_fuse(void* value, void* recv, void* arg);
+
+// An operator msg whose operands are constants (int and string literals,
+// or other such msgs) is folded: the first time it's sent, its value is
+// kept in the msg, and sending it again gives that value, for as long as
+// the operator still resolves to the same op method and Int's and
+// String's methods (and the msg's args) haven't been written to. Only
+// primitive int operators and string `++` are folded, and the ints and
+// strings kept are frozen. Define FUGA_FOLD to 0 when compiling to turn
+// this off.
+#ifndef FUGA_FOLD
+#define FUGA_FOLD 1
+#endif
 
 #define FUGA_METHOD(fn) (FugaMethodN_new_(self, (FugaMethodFnN)(fn)))
+#define FUGA_METHOD_TAIL(fn) (FugaMethodT_new_(self,(FugaMethodFnT)(fn)))
 #define FUGA_METHOD_0(fn) (FugaMethod0_new_(self,(FugaMethodFn0)(fn)))
 #define FUGA_METHOD_1(fn) (FugaMethod1_new_(self,(FugaMethodFn1)(fn)))
 #define FUGA_METHOD_2(fn) (FugaMethod2_new_(self,(FugaMethodFn2)(fn)))
+#define FUGA_METHOD_V(fn) (FugaMethodV_new_(self,(FugaMethodFnV)(fn)))
 #define FUGA_METHOD_STR(fn) (FugaMethodStr_new_(self,(FugaMethodFn0)fn))
 #define FUGA_METHOD_OP(name) (FugaMethodOp_new_(self, name))
 
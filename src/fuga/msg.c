@@ -1,5 +1,7 @@
 #include "msg.h"
 #include "thunk.h"
+#include "frame.h"
+#include "code.h"
 #include "test.h"
 
 const FugaType FugaMsg_type = {
@@ -33,6 +35,8 @@ void FugaMsg_mark(
 ) {
     FugaMsg* self = _self;
     Fuga_mark_(self, self->name);
+    Fuga_mark_(self, self->folded);
+    Fuga_mark_(self, self->foldOp);
 }
 
 FugaMsg* FugaMsg_fromSymbol(
@@ -45,10 +49,12 @@ FugaMsg* FugaMsg_fromSymbol(
             "Msg toSymbol: expected primitive symbol"
         );
 
-    FugaMsg* result = Fuga_clone_(FUGA->Msg, sizeof(FugaMsg));
+    FugaMsg* result = Fuga_cloneInline_(FUGA->Msg, sizeof(FugaMsg));
     Fuga_type_(result, &FugaMsg_type);
     Fuga_onMark_(result, FugaMsg_mark);
-    result->name = self;
+    result->name   = self;
+    result->depth  = -1;
+    result->offset = -1;
     return result;
 }
 
@@ -88,7 +94,7 @@ void* FugaMsg_args(
     return Fuga_slots(self);
 }
 
-void* FugaMsg_eval_in_(FugaMsg* self, void* recv, void* scope)
+void* FugaMsg_resolve(FugaMsg* self, void* recv, void* scope)
 {
     ALWAYS(self);    ALWAYS(recv);    ALWAYS(scope);
     FUGA_NEED(self); FUGA_NEED(recv); FUGA_NEED(scope);
@@ -97,9 +103,78 @@ void* FugaMsg_eval_in_(FugaMsg* self, void* recv, void* scope)
             "Msg eval: expected primitive msg"
         );
 
-    void* name = FugaMsg_name(self);
+    // Locals resolved by FugaFrame_resolve are found by their coordinates.
+    void* value = NULL;
+    if (!Fuga_length(self) && recv == scope && self->depth >= 0)
+        value = FugaFrame_get(scope, self->name, self->depth, self->offset);
+    if (!value)
+        value = Fuga_get(recv, self->name);
+    FUGA_NEED(value);
+    return value;
+}
+
+void* FugaMsg_apply(
+    FugaMsg* self,
+    void* value,
+    void* recv,
+    void* scope,
+    bool tail
+) {
+    ALWAYS(self); ALWAYS(value); ALWAYS(recv); ALWAYS(scope);
+
+    // A msg without args that resolves to a plain value (a variable, most
+    // of the time) evaluates to that value. Its empty args would only be
+    // evaluated to check that they're empty, so don't make a thunk.
+    if (!Fuga_isMethod(value) && !Fuga_length(self))
+        return value;
+
+    // Operators go straight to their left operand.
+    if (Fuga_length(self) == 2) {
+        void* result = FugaMethodOp_send(value, self, scope);
+        if (result)
+            return result;
+    }
+
+    // Strict methods get their args evaluated right away, without thunks,
+    // and without an args object if the args are simple enough.
+    if (FugaMethod_isStrict(value)) {
+        void* argv[FUGA_METHOD_ARGC];
+        size_t argc;
+        void* args = FugaCode_evalArgs(FugaMsg_args(self), scope,
+                                       &argc, argv, FUGA_METHOD_ARGC);
+        if (!args)
+            return FugaMethod_callStrict(value, recv, argc, argv);
+        FUGA_CHECK(args);
+        return FugaMethod_call(value, recv, args);
+    }
+
+    // Control forms evaluate their args as they go, straight from the msg.
+    if (FugaMethod_isForm(value))
+        return FugaMethod_callForm(value, recv, FugaMsg_args(self), scope,
+                                   tail);
+
     void* args = Fuga_lazy_(FugaMsg_args(self), scope);
-    return Fuga_send(recv, name, args);
+    if (tail && Fuga_isMethod(value))
+        return FugaMethod_tail(value, recv, args);
+    return Fuga_call(value, recv, args);
+}
+
+static void* FugaMsg_send_(FugaMsg* self, void* recv, void* scope, bool tail)
+{
+    void* value = FugaMsg_resolve(self, recv, scope);
+    FUGA_CHECK(value);
+    recv = Fuga_need(recv);
+    return FugaMsg_apply(self, value, recv, scope, tail);
+}
+
+void* FugaMsg_eval_in_(FugaMsg* self, void* recv, void* scope)
+{
+    return FugaMsg_send_(self, recv, scope, false);
+}
+
+void* FugaMsg_evalTail(FugaMsg* self, void* recv, void* scope)
+{
+    return FugaMsg_send_(self, recv, scope, true);
 }
 
 void* FugaMsg_str(void* self)
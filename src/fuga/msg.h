@@ -5,6 +5,16 @@
 
 struct FugaMsg {
     FugaSymbol* name;
+    // Where the name lives, if the msg refers to a local (see FugaFrame):
+    // the number of frames up the scope chain, and the offset in that
+    // frame. Both are -1 when the name is looked up dynamically.
+    long depth;
+    long offset;
+    // What an operator msg on constants was folded to, and what that
+    // depends on (see FugaMethodOp_send). NULL if it hasn't been folded.
+    void*  folded;
+    void*  foldOp;
+    size_t foldVersion;
 };
 
 void FugaMsg_init(void*);
@@ -16,6 +26,16 @@ FugaMsg* FugaMsg_new_(void*, const char*);
 FugaMsg* FugaMsg_fromSymbol(FugaSymbol*);
 FugaSymbol* FugaMsg_toSymbol(FugaMsg*);
 void* FugaMsg_eval_in_(FugaMsg* self, void* recv, void* scope);
+void* FugaMsg_evalTail(FugaMsg* self, void* recv, void* scope);
+
+// Sending a msg is two steps: resolving its name, from `recv` (or from
+// the frame it refers to, see FugaFrame), and applying what that gives to
+// its args. Code compiled ahead of time (see FugaCode_compiled_) takes the
+// first step, and only takes the second if it can't evaluate the args
+// itself.
+void* FugaMsg_resolve(FugaMsg* self, void* recv, void* scope);
+void* FugaMsg_apply(FugaMsg* self, void* value, void* recv, void* scope,
+                    bool tail);
 void* FugaMsg_name(FugaMsg*);
 void* FugaMsg_args(FugaMsg*);
 void* FugaMsg_str(void*);
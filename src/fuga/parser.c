@@ -2,8 +2,16 @@
 #include "parser.h"
 #include "test.h"
 
+#include <string.h>
+
 struct FugaParser {
     FugaLexer* lexer;
+
+    // The int and string literals parsed so far (see FugaParser_literal),
+    // in an open-addressing table: `literalsSize` is a power of two, or 0.
+    void** literals;
+    size_t literalsSize;
+    size_t literalsLength;
 };
 
 void FugaParser_mark(
@@ -11,6 +19,15 @@ void FugaParser_mark(
 ) {
     FugaParser* parser = _parser;
     Fuga_mark_(parser, parser->lexer);
+    for (size_t i = 0; i < parser->literalsSize; i++)
+        Fuga_mark_(parser, parser->literals[i]);
+}
+
+void FugaParser_free(
+    void *_parser
+) {
+    FugaParser* parser = _parser;
+    free(parser->literals);
 }
 
 FugaParser* FugaParser_new(
@@ -18,13 +35,90 @@ FugaParser* FugaParser_new(
 ) {
     FugaParser* parser = Fuga_clone_(FUGA->Object, sizeof(FugaParser));
     Fuga_onMark_(parser, FugaParser_mark);
+    Fuga_onFree_(parser, FugaParser_free);
     return parser;
 }
 
+/**
+ * The value of an int or string token. Equal literals parsed from the
+ * same source (one FugaParser_readCode_ or FugaParser_readFile_: a
+ * module, or a line of the REPL) are the same object, made once and
+ * frozen (see Fuga_freeze), so that a file with many repeated literals
+ * doesn't hold a copy of each. The pool is emptied when the parser is
+ * given new source, so it doesn't keep every literal it ever read.
+ */
+static void* FugaParser_literal(
+    FugaParser* self,
+    FugaToken* token
+) {
+    bool isInt = token->type == FUGA_TOKEN_INT;
+    const char* text = token->value;
+    size_t size = isInt ? 0 : strlen(text);
+    size_t hash = isInt ? (size_t)token->number
+                        : FugaString_hash(text, size);
+
+    size_t i = 0;
+    if (self->literalsSize) {
+        size_t mask = self->literalsSize - 1;
+        for (i = hash & mask; self->literals[i]; i = (i+1) & mask) {
+            void* literal = self->literals[i];
+            if (isInt ? Fuga_isInt(literal)
+                        && FugaInt_value(literal) == token->number
+                      : Fuga_isString(literal)
+                        && ((FugaString*)literal)->size == size
+                        && !memcmp(((FugaString*)literal)->data, text, size))
+                return literal;
+        }
+    }
+
+    void* literal = isInt ? (void*)FugaToken_int(token)
+                          : (void*)FugaToken_string(token);
+    FUGA_CHECK(literal);
+    Fuga_freeze(literal);
+    if (2*(self->literalsLength+1) > self->literalsSize) {
+        size_t size = self->literalsSize ? 2*self->literalsSize : 64;
+        void** old = self->literals;
+        size_t oldSize = self->literalsSize;
+        self->literals = calloc(size, sizeof(void*));
+        self->literalsSize = size;
+        ALWAYS(self->literals);
+        for (size_t j = 0; j < oldSize; j++) {
+            if (!old[j])
+                continue;
+            void* value = old[j];
+            size_t h = Fuga_isInt(value)
+                     ? (size_t)FugaInt_value(value)
+                     : FugaString_hash(((FugaString*)value)->data,
+                                       ((FugaString*)value)->size);
+            size_t k = h & (size-1);
+            while (self->literals[k])
+                k = (k+1) & (size-1);
+            self->literals[k] = value;
+        }
+        free(old);
+        i = hash & (size-1);
+        while (self->literals[i])
+            i = (i+1) & (size-1);
+    }
+    self->literals[i] = literal;
+    self->literalsLength++;
+    return literal;
+}
+
+static void FugaParser_clearLiterals(
+    FugaParser* self
+) {
+    free(self->literals);
+    self->literals       = NULL;
+    self->literalsSize   = 0;
+    self->literalsLength = 0;
+}
+
 void FugaParser_readCode_(
     FugaParser* parser,
     const char* code
 ) {
+    FugaParser_clearLiterals(parser);
     parser->lexer = FugaLexer_new(parser);
     FugaLexer_readCode_(parser->lexer, code);
 }
@@ -33,6 +127,7 @@ bool FugaParser_readFile_(
     FugaParser* parser,
     const char* filename
 ) {
+    FugaParser_clearLiterals(parser);
     parser->lexer = FugaLexer_new(parser);
     return FugaLexer_readFile_(parser->lexer, filename);
 }
@@ -128,7 +223,7 @@ void* FugaParser_msg(
     if (FugaParser_check_(self, FUGA_TOKEN_LPAREN)) {
         void* block = FugaParser_object(self);
         FUGA_CHECK(block);
-        FUGA_HEADER(msg)->slots = FUGA_HEADER(block)->slots;
+        FugaSlots_share_(Fuga_slots(msg), Fuga_slots(block));
     }
 
     return msg;
@@ -154,12 +249,9 @@ void* FugaParser_root(
         return value;
 
     case FUGA_TOKEN_INT:
-        FugaParser_advance(self);
-        return FugaToken_int(token);
-
     case FUGA_TOKEN_STRING:
         FugaParser_advance(self);
-        return FugaToken_string(token);
+        return FugaParser_literal(self, token);
 
     case FUGA_TOKEN_SYMBOL:
         FugaParser_advance(self);
@@ -412,6 +504,23 @@ TESTS(FugaParser) {
         &&  FugaString_is_(Fuga_getDocI(self, 0), "foo  \nbar\n")
         &&  FugaInt_is_(Fuga_getI(self, 0), 20));
 
+    FUGA_PARSER_TEST("(10, \"do\", 10, \"do\", 20, \"re\")",
+           Fuga_is_(Fuga_getI(self, 0), Fuga_getI(self, 2))
+        && Fuga_is_(Fuga_getI(self, 1), Fuga_getI(self, 3))
+        && !Fuga_is_(Fuga_getI(self, 0), Fuga_getI(self, 4))
+        && !Fuga_is_(Fuga_getI(self, 1), Fuga_getI(self, 5))
+        && Fuga_isFrozen(Fuga_getI(self, 1))
+        && Fuga_isRaised(Fuga_set(Fuga_getI(self, 1),
+                                  FUGA_SYMBOL("x"), FUGA_INT(1)))
+        && Fuga_isRaised(Fuga_append_(Fuga_getI(self, 4), FUGA_INT(1))));
+
+    // new source, new pool.
+    FugaParser_readCode_(parser, "\"do\"");
+    void* first = FugaParser_expression(parser);
+    FugaParser_readCode_(parser, "\"do\"");
+    void* second = FugaParser_expression(parser);
+    TEST(FugaString_is_(first, "do") && FugaString_is_(second, "do"));
+    TEST(first != second);
 
     Fuga_quit(self);
 }
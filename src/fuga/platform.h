@@ -10,5 +10,30 @@
 #define FUGA_PLATFORM_FUGAPATH      getenv("FUGAPATH")
 #define FUGA_PLATFORM_FUGAPATH_SEP  ":"
 
+// Whether there's a code generator for this target (see FugaJit), and
+// whether it's been turned off.
+#if defined(__x86_64__) && defined(__linux__)
+#define FUGA_PLATFORM_JIT           1
+#else
+#define FUGA_PLATFORM_JIT           0
+#endif
+#define FUGA_PLATFORM_NOJIT         getenv("FUGA_NOJIT")
+
+// The soft limit on the size of the C stack, in bytes, or 0 if there's
+// none or it can't be found out (see FUGA_STACK_LIMIT).
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+static inline size_t FugaPlatform_stackSize(void)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_STACK, &limit) || limit.rlim_cur == RLIM_INFINITY)
+        return 0;
+    return limit.rlim_cur;
+}
+#define FUGA_PLATFORM_STACK_SIZE    FugaPlatform_stackSize()
+#else
+#define FUGA_PLATFORM_STACK_SIZE    0
+#endif
+
 #endif
 
@@ -2,6 +2,10 @@
 #include "method.h"
 #include "test.h"
 #include "loader.h"
+#include "code.h"
+#include "parser.h"
+#include "frame.h"
+#include "memo.h"
 
 void FugaPrelude_defOp(
     void* self,
@@ -34,30 +38,58 @@ void FugaPrelude_init(
     Fuga_setS(FUGA->Prelude, "ValueError",  FUGA->ValueError);
     Fuga_setS(FUGA->Prelude, "TypeError",   FUGA->TypeError);
     Fuga_setS(FUGA->Prelude, "IOError",     FUGA->IOError);
+    Fuga_setS(FUGA->Prelude, "RecursionError", FUGA->RecursionError);
+    Fuga_setS(FUGA->Prelude, "Break",       FUGA->Break);
+    Fuga_setS(FUGA->Prelude, "Continue",    FUGA->Continue);
+    Fuga_setS(FUGA->Prelude, "Return",      FUGA->Return);
     Fuga_setS(FUGA->Prelude, "Thunk",       FUGA->Thunk);
+    Fuga_setS(FUGA->Prelude, "Range",       FUGA->Range);
+    Fuga_setS(FUGA->Prelude, "Iter",        FUGA->Iter);
     Fuga_setS(FUGA->Prelude, "Path",        FUGA->Path);
     Fuga_setS(FUGA->Prelude, "Loader",      FugaLoader_new(self));
 
     Fuga_setS(FUGA->Prelude, "_name",   FUGA_STRING("Prelude"));
     Fuga_setS(FUGA->Prelude, "=",      FUGA_METHOD(FugaPrelude_equals));
     Fuga_setS(FUGA->Prelude, ":=",     FUGA_METHOD(FugaPrelude_modify));
-    Fuga_setS(FUGA->Prelude, "if",     FUGA_METHOD(FugaPrelude_if));
+    Fuga_setS(FUGA->Prelude, "if",     FUGA_METHOD_TAIL(FugaPrelude_if));
     Fuga_setS(FUGA->Prelude, "method", FUGA_METHOD(FugaPrelude_method));
     Fuga_setS(FUGA->Prelude, "print",  FUGA_METHOD(FugaPrelude_print));
     Fuga_setS(FUGA->Prelude, "import", FUGA_METHOD(FugaPrelude_import));
     Fuga_setS(FUGA->Prelude, "match",  FUGA_METHOD(FugaPrelude_match));
-    Fuga_setS(FUGA->Prelude, "do",     FUGA_METHOD(FugaPrelude_do));
+    Fuga_setS(FUGA->Prelude, "do",     FUGA_METHOD_TAIL(FugaPrelude_do));
     Fuga_setS(FUGA->Prelude, "def",    FUGA_METHOD(FugaPrelude_def));
     Fuga_setS(FUGA->Prelude, "help",   FUGA_METHOD(FugaPrelude_help));
     Fuga_setS(FUGA->Prelude, "try",    FUGA_METHOD(FugaPrelude_try));
+    Fuga_setS(FUGA->Prelude, "memo",   FUGA_METHOD(FugaMemo_memo));
+    Fuga_setS(FUGA->Prelude, "memoStats", FUGA_METHOD(FugaMemo_memoStats));
 
     Fuga_setS(FUGA->Prelude, "is?",    FUGA_METHOD_2(FugaPrelude_is));
     Fuga_setS(FUGA->Prelude, "isa?",   FUGA_METHOD_2(FugaPrelude_isa));
 
-    Fuga_setS(FUGA->Prelude, "or",     FUGA_METHOD(FugaPrelude_orM));
-    Fuga_setS(FUGA->Prelude, "and",    FUGA_METHOD(FugaPrelude_andM));
+    Fuga_setS(FUGA->Prelude, "or",     FUGA_METHOD_TAIL(FugaPrelude_orM));
+    Fuga_setS(FUGA->Prelude, "and",    FUGA_METHOD_TAIL(FugaPrelude_andM));
     Fuga_setS(FUGA->Prelude, "not",    FUGA_METHOD_1(FugaPrelude_notM));
 
+    Fuga_setS(FUGA->Prelude, "while",  FUGA_METHOD_TAIL(FugaPrelude_while));
+    Fuga_setS(FUGA->Prelude, "for",    FUGA_METHOD_TAIL(FugaPrelude_for));
+    Fuga_setS(FUGA->Int,     "times",  FUGA_METHOD_TAIL(FugaPrelude_times));
+    Fuga_setS(FUGA->Prelude, "break",  FUGA_METHOD_TAIL(FugaPrelude_break));
+    Fuga_setS(FUGA->Prelude, "continue",
+        FUGA_METHOD_TAIL(FugaPrelude_continue));
+    Fuga_setS(FUGA->Prelude, "return", FUGA_METHOD_TAIL(FugaPrelude_return));
+
+    Fuga_setS(FUGA->Object,  "at",     FUGA_METHOD_1(FugaPrelude_at));
+    Fuga_setS(FUGA->Object,  "iter",   FUGA_METHOD_0(FugaPrelude_iter));
+    Fuga_setS(FUGA->Object,  "empty",  FUGA_METHOD_0(FugaPrelude_empty));
+    Fuga_setS(FUGA->Object,  "map",    FUGA_METHOD(FugaPrelude_map));
+    Fuga_setS(FUGA->Iter,    "iter",   FUGA_METHOD_0(FugaIter_iter));
+    Fuga_setS(FUGA->Iter,    "done?",  FUGA_METHOD_0(FugaIter_done));
+    Fuga_setS(FUGA->Iter,    "value",  FUGA_METHOD_0(FugaIter_value));
+    Fuga_setS(FUGA->Iter,    "next!",  FUGA_METHOD_0(FugaIter_next));
+    Fuga_setS(FUGA->Prelude, "range",  FUGA_METHOD(FugaPrelude_range));
+    Fuga_setS(FUGA->Range,   "at",     FUGA_METHOD_1(FugaRange_at));
+    Fuga_setS(FUGA->Range,   "str",    FUGA_METHOD_STR(FugaRange_str));
+
     FugaPrelude_defOp(FUGA->Prelude, "==");
     FugaPrelude_defOp(FUGA->Prelude, "!=");
     FugaPrelude_defOp(FUGA->Prelude, "<");
@@ -234,42 +266,53 @@ TESTS(FugaPrelude_equals) {
 }
 #endif
 
+// Evaluate the branch an `if` takes. In tail position, leave it to the
+// caller (see FugaCode_evalTail), unless it has already been evaluated.
+static void* FugaPrelude_branch(void* self, void* scope, bool tail)
+{
+    if (tail && scope && !FugaMsg_is_(self, "~")) {
+        FUGA->tail = (FugaTail){.code = self, .scope = scope};
+        return FUGA->Tail;
+    }
+    return Fuga_needIn(self, scope);
+}
+
 void* FugaPrelude_if(
     void* self,
-    void* args
+    void* code,
+    void* scope,
+    bool tail
 ) {
-    ALWAYS(self); ALWAYS(args);
+    ALWAYS(self); ALWAYS(code);
     FUGA_NEED(self);
-    args = Fuga_lazySlots(args);
-    FUGA_CHECK(args);
 
-    long length = Fuga_length(args);
+    long length = Fuga_length(code);
     if (length < 2)
         FUGA_RAISE(FUGA->TypeError, "if: expected 2 or more arguments");
     for (long i = 0; i < length-1; i += 2) {
-        void* cond = Fuga_getI(args, i);
-        FUGA_NEED(cond);
+        void* cond = Fuga_needIn(Fuga_getI(code, i), scope);
+        FUGA_CHECK(cond);
         if (Fuga_isTrue(cond))
-            return Fuga_needOnce(Fuga_getI(args, i+1));
+            return FugaPrelude_branch(Fuga_getI(code, i+1), scope, tail);
         if (!Fuga_isFalse(cond))
             FUGA_RAISE(FUGA->TypeError,
                 "if: expected condition to be boolean"
             );
     }
     if (length & 1)
-        return Fuga_needOnce(Fuga_getI(args, length-1));
+        return FugaPrelude_branch(Fuga_getI(code, length-1), scope, tail);
     else
         return FUGA->nil;
 }
 
-void* FugaPrelude_orM(void* self, void* args) {
-	ALWAYS(self); ALWAYS(args);
+void* FugaPrelude_orM(void* self, void* code, void* scope, bool tail) {
+	ALWAYS(self); ALWAYS(code);
 	FUGA_NEED(self);
-	args = Fuga_lazySlots(args);
-	FUGA_CHECK(args);
 
-	FUGA_FOR(i, arg, args) {
-		FUGA_NEED(arg);
+	long length = Fuga_length(code);
+	for (long i = 0; i < length; i++) {
+		void* arg = Fuga_needIn(Fuga_getI(code, i), scope);
+		FUGA_CHECK(arg);
 		if (Fuga_isTrue(arg))
 			return FUGA->True;
 		if (!Fuga_isFalse(arg))
@@ -279,14 +322,14 @@ void* FugaPrelude_orM(void* self, void* args) {
 	return FUGA->False;
 }
 
-void* FugaPrelude_andM    (void* self, void* args) {
-	ALWAYS(self); ALWAYS(args);
+void* FugaPrelude_andM(void* self, void* code, void* scope, bool tail) {
+	ALWAYS(self); ALWAYS(code);
 	FUGA_NEED(self);
-	args = Fuga_lazySlots(args);
-	FUGA_CHECK(args);
 
-	FUGA_FOR(i, arg, args) {
-		FUGA_NEED(arg);
+	long length = Fuga_length(code);
+	for (long i = 0; i < length; i++) {
+		void* arg = Fuga_needIn(Fuga_getI(code, i), scope);
+		FUGA_CHECK(arg);
 		if (Fuga_isFalse(arg))
 			return FUGA->False;
 		if (!Fuga_isTrue(arg))
@@ -296,6 +339,44 @@ void* FugaPrelude_andM    (void* self, void* args) {
 	return FUGA->True;
 }
 
+#ifdef TESTING
+TESTS(FugaPrelude_if) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Object);
+    Fuga_setS(scope, "yes", FUGA->True);
+    Fuga_setS(scope, "no",  FUGA->False);
+    Fuga_setS(scope, "a",   FUGA_INT(10));
+
+    void* code = Fuga_clone(FUGA->Object);
+    Fuga_append_(code, FUGA_MSG("no"));
+    Fuga_append_(code, FUGA_MSG("oops"));
+    Fuga_append_(code, FUGA_MSG("yes"));
+    Fuga_append_(code, FUGA_MSG("a"));
+    TEST(FugaInt_is_(FugaPrelude_if(self, code, scope, false), 10));
+    TEST(FugaPrelude_if(self, code, scope, true) == FUGA->Tail);
+    TEST(FUGA->tail.code == Fuga_getI(code, 3));
+    TEST(FUGA->tail.scope == scope);
+    FUGA->tail = (FugaTail){.code = NULL};
+    TEST(Fuga_isRaised(FugaPrelude_orM(self, code, scope, false)));
+    TEST(Fuga_isFalse(FugaPrelude_andM(self, code, scope, false)));
+
+    void* args = Fuga_clone(FUGA->Object);
+    Fuga_append_(args, FUGA->False);
+    Fuga_append_(args, FUGA_INT(1));
+    Fuga_append_(args, FUGA_INT(2));
+    TEST(FugaInt_is_(FugaPrelude_if(self, args, NULL, true), 2));
+    TEST(Fuga_isRaised(FugaPrelude_orM(self, args, NULL, false)));
+
+    code = Fuga_clone(FUGA->Object);
+    Fuga_append_(code, FUGA_MSG("no"));
+    Fuga_append_(code, FUGA_MSG("a"));
+    TEST(Fuga_isNil(FugaPrelude_if(self, code, scope, false)));
+    TEST(Fuga_isRaised(FugaPrelude_if(self, code, NULL, false)));
+
+    Fuga_quit(self);
+}
+#endif
+
 void* FugaPrelude_notM  (void* self, void* arg) {
 	ALWAYS(self); ALWAYS(arg);
 	FUGA_NEED(self); FUGA_NEED(arg);
@@ -306,6 +387,712 @@ void* FugaPrelude_notM  (void* self, void* arg) {
 	FUGA_RAISE(FUGA->TypeError, "not: expected only a boolean");
 }
 
+/**
+ * Loops: `while(cond, body..)`, `for(x, xs, body..)`, `n times(body..)`.
+ *
+ * A loop evaluates the slots of its body in the scope it was called
+ * from, so an iteration allocates nothing the body doesn't. for binds
+ * `x` in a clone of that scope: a single one, made once, unless the body
+ * makes methods or thunks (it has a `method`, `def`, block or `lazy` in
+ * it), which could keep the scope past its iteration. Then, as in `map`,
+ * each element gets a clone of its own.
+ *
+ * `break` and `continue` raise `FUGA->Break` and `FUGA->Continue`
+ * themselves, without cloning them, with the id of the call they were
+ * made in (see `FugaFrame_call`, 0 outside of any method) left in
+ * `FUGA->unwind`. A loop only stops them if they come from its own call,
+ * so one made in a method called from a loop isn't taken for the
+ * loop's: the method's call turns it into an error instead (see
+ * `FugaMethodFuga_call`). Loops evaluate to nil, or to the value given
+ * to `break`.
+ */
+
+// The id of the call whose body `scope` is in, or 0.
+static size_t FugaPrelude_callOf(void* scope)
+{
+    void* frame = FugaFrame_of(scope);
+    return frame ? FugaFrame_call(frame) : 0;
+}
+
+// Evaluate the body of a loop, the slots of `code` from `start` on, once.
+// Returns NULL to go on looping, or what the loop should return.
+static void* FugaPrelude_loopBody(
+    void* self,
+    long start,
+    void* scope,
+    size_t call
+) {
+    long length = Fuga_length(self);
+    for (long i = start; i < length; i++) {
+        void* result = Fuga_needIn(Fuga_getI(self, i), scope);
+        void* exception = Fuga_catch(result);
+        if (!exception)
+            continue;
+        if ((exception != FUGA->Continue && exception != FUGA->Break)
+                || FUGA->unwind.call != call)
+            return result;
+        if (exception == FUGA->Continue) {
+            FUGA->unwind = (FugaUnwind){.value = NULL};
+            return NULL;
+        }
+        if (exception == FUGA->Break) {
+            void* value = FUGA->unwind.value;
+            FUGA->unwind = (FugaUnwind){.value = NULL};
+            return value ? value : FUGA->nil;
+        }
+        return result;
+    }
+    return NULL;
+}
+
+void* FugaPrelude_while(void* self, void* code, void* scope, bool tail)
+{
+    ALWAYS(self); ALWAYS(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "while: expected unevaluated code");
+    if (Fuga_length(code) < 1)
+        FUGA_RAISE(FUGA->TypeError, "while: expected a condition");
+
+    void* cond = Fuga_getI(code, 0);
+    size_t call = FugaPrelude_callOf(scope);
+    while (true) {
+        void* test = Fuga_needIn(cond, scope);
+        FUGA_CHECK(test);
+        if (Fuga_isFalse(test))
+            return FUGA->nil;
+        if (!Fuga_isTrue(test))
+            FUGA_RAISE(FUGA->TypeError,
+                "while: expected condition to be boolean"
+            );
+        void* result = FugaPrelude_loopBody(code, 1, scope, call);
+        if (result)
+            return result;
+    }
+}
+
+// Can for loop over the slots of xs, instead of going through `xs iter`?
+// Yes, if xs gets iter, len and at from Object.
+static bool FugaPrelude_forSlots(void* self, void* xs)
+{
+    const char* names[] = {"iter", "len", "at"};
+    for (size_t i = 0; i < sizeof names / sizeof *names; i++) {
+        void* name = FUGA_SYMBOL(names[i]);
+        void* mine = Fuga_get(xs, name);
+        if (Fuga_isRaised(mine) || mine != Fuga_get(FUGA->Object, name))
+            return false;
+    }
+    return true;
+}
+
+// Could evaluating `code` keep its scope, in a method or a thunk?
+static bool FugaPrelude_captures(void* self, void* code)
+{
+    if (Fuga_isRaised(code) || Fuga_isInt(code) || Fuga_isString(code))
+        return false;
+    if (Fuga_isMsg(code)) {
+        void* name = FugaMsg_name(code);
+        if (name == FUGA_SYMBOL("method") || name == FUGA_SYMBOL("def")
+                                          || name == FUGA_SYMBOL("lazy"))
+            return true;
+    }
+    FugaSlots* slots = FUGA_HEADER(code)->slots;
+    long length = slots ? FugaSlots_length(slots) : 0;
+    for (long i = 0; i < length; i++)
+        if (FugaPrelude_captures(self, FugaSlots_valueByIndex(slots, i)))
+            return true;
+    return false;
+}
+
+void* FugaPrelude_for(void* self, void* code, void* scope, bool tail)
+{
+    ALWAYS(self); ALWAYS(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "for: expected unevaluated code");
+    if (Fuga_length(code) < 2)
+        FUGA_RAISE(FUGA->TypeError, "for: expected a name and a value");
+    void* x = Fuga_getI(code, 0);
+    if (!Fuga_isMsg(x) || Fuga_length(x))
+        FUGA_RAISE(FUGA->TypeError, "for: expected a name");
+    void* name = FugaMsg_name(x);
+    FUGA_CHECK(name);
+    void* xs = Fuga_needIn(Fuga_getI(code, 1), scope);
+    FUGA_CHECK(xs);
+
+    bool fresh = false;
+    for (long i = 2; i < Fuga_length(code) && !fresh; i++)
+        fresh = FugaPrelude_captures(self, Fuga_getI(code, i));
+    size_t call = FugaPrelude_callOf(scope);
+    void* outer = scope;
+    scope = Fuga_clone(outer);
+    if (FugaPrelude_forSlots(self, xs)) {
+        for (long i = 0; i < Fuga_length(xs); i++) {
+            if (fresh && i)
+                scope = Fuga_clone(outer);
+            FUGA_CHECK(Fuga_set(scope, name, Fuga_getI(xs, i)));
+            void* result = FugaPrelude_loopBody(code, 2, scope, call);
+            if (result)
+                return result;
+        }
+        return FUGA->nil;
+    }
+
+    void* iter = Fuga_sendN(xs, FUGA_SYMBOL("iter"), 0, NULL);
+    FUGA_CHECK(iter);
+    void* done  = FUGA_SYMBOL("done?");
+    void* value = FUGA_SYMBOL("value");
+    void* next  = FUGA_SYMBOL("next!");
+    for (long i = 0; true; i++) {
+        void* test = Fuga_sendN(iter, done, 0, NULL);
+        FUGA_NEED(test);
+        if (Fuga_isTrue(test))
+            return FUGA->nil;
+        if (!Fuga_isFalse(test))
+            FUGA_RAISE(FUGA->TypeError, "for: expected done? to be boolean");
+        if (fresh && i)
+            scope = Fuga_clone(outer);
+        FUGA_CHECK(Fuga_set(scope, name, Fuga_sendN(iter, value, 0, NULL)));
+        void* result = FugaPrelude_loopBody(code, 2, scope, call);
+        if (result)
+            return result;
+        FUGA_CHECK(Fuga_sendN(iter, next, 0, NULL));
+    }
+}
+
+void* FugaPrelude_times(void* self, void* code, void* scope, bool tail)
+{
+    ALWAYS(self); ALWAYS(code);
+    FUGA_NEED(self);
+    if (!Fuga_isInt(self))
+        FUGA_RAISE(FUGA->TypeError, "times: expected primitive int");
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "times: expected unevaluated code");
+    size_t call = FugaPrelude_callOf(scope);
+    for (long i = FugaInt_value(self); i > 0; i--) {
+        void* result = FugaPrelude_loopBody(code, 0, scope, call);
+        if (result)
+            return result;
+    }
+    return FUGA->nil;
+}
+
+void* FugaPrelude_break(void* self, void* code, void* scope, bool tail)
+{
+    ALWAYS(self); ALWAYS(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "break: expected unevaluated code");
+    long length = Fuga_length(code);
+    if (length > 1)
+        FUGA_RAISE(FUGA->TypeError, "break: expected at most 1 argument");
+    void* value = length ? Fuga_needIn(Fuga_getI(code, 0), scope) : NULL;
+    if (value)
+        FUGA_CHECK(value);
+    FUGA->unwind = (FugaUnwind){
+        .call = FugaPrelude_callOf(scope), .value = value
+    };
+    return Fuga_raise(FUGA->Break);
+}
+
+void* FugaPrelude_continue(void* self, void* code, void* scope, bool tail)
+{
+    ALWAYS(self); ALWAYS(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "continue: expected unevaluated code");
+    if (Fuga_length(code))
+        FUGA_RAISE(FUGA->TypeError, "continue: expected no arguments");
+    FUGA->unwind = (FugaUnwind){.call = FugaPrelude_callOf(scope)};
+    return Fuga_raise(FUGA->Continue);
+}
+
+/**
+ * `return(value)`: exit the method whose body this is, with `value` (or
+ * nil). In tail position that's just the value, left to the caller like
+ * a branch of `if`. Otherwise, `FUGA->Return` is raised as is, with the
+ * id of the call to exit from, and the call's trampoline catches it
+ * (see `FugaMethodFuga_call`).
+ */
+void* FugaPrelude_return(void* self, void* code, void* scope, bool tail)
+{
+    ALWAYS(self); ALWAYS(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "return: expected unevaluated code");
+    long length = Fuga_length(code);
+    if (length > 1)
+        FUGA_RAISE(FUGA->TypeError, "return: expected at most 1 argument");
+    void* frame = FugaFrame_of(scope);
+    if (!frame)
+        FUGA_RAISE(FUGA->TypeError, "return: expected to be in a method");
+    if (length && tail)
+        return FugaPrelude_branch(Fuga_getI(code, 0), scope, tail);
+    void* value = length ? Fuga_needIn(Fuga_getI(code, 0), scope)
+                         : FUGA->nil;
+    FUGA_CHECK(value);
+    if (tail)
+        return value;
+    FUGA->unwind = (FugaUnwind){
+        .call = FugaFrame_call(frame), .value = value
+    };
+    return Fuga_raise(FUGA->Return);
+}
+
+#ifdef TESTING
+TESTS(FugaPrelude_while) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "n = 0\n"
+        "while(n < 10, n := [n + 1])\n"
+        "for(x, (1, 2, 3, 4), if(x == 3, break), n := [n + x])\n"
+        "5 times(if(n > 14, continue), n := [n + 100])\n"
+        "f(x) { if(x == 2, break(:from_f)), x }\n"
+        "k() { (1, 2, 3) map(x, if(x == 2, break(x), x)) }\n"
+        "r = try(while(true, f(1), f(2), n := 0), Break, exception)\n"
+        "s = try(for(y, (1, 2), k()), Break, exception)\n"
+        "fs = ()\n"
+        "for(x, (1, 2, 3), fs append!(method((), x)))\n"
+        "p = fs at(0), q = fs at(2)\n"
+        "m = (p(), q())\n"
+    );
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "_this", scope)));
+    TEST(Fuga_isNil(FugaCode_evalIn(code, scope)));
+    TEST(FugaInt_is_(Fuga_getS(scope, "n"), 113));
+    void* m = Fuga_getS(scope, "m");
+    TEST(FugaInt_is_(Fuga_getI(m, 0), 1) && FugaInt_is_(Fuga_getI(m, 1), 3));
+    void* none = Fuga_clone(FUGA->Object);
+    TEST(Fuga_catch(FugaPrelude_break(self, none, scope, false))
+         == FUGA->Break);
+    FUGA->unwind = (FugaUnwind){.value = NULL};
+
+    // A break from a method called in a loop doesn't stop the loop.
+    void* r = Fuga_getS(scope, "r");
+    void* s = Fuga_getS(scope, "s");
+    TEST(Fuga_isa_(r, FUGA->Break) && r != FUGA->Break);
+    TEST(Fuga_isa_(s, FUGA->Break) && s != FUGA->Break);
+    TEST(FugaString_is_(Fuga_getS(r, "msg"), "break outside of a loop"));
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaPrelude_return) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "find(xs, y) { for(x, xs, if(x == y, return(x * 10))), 0 }\n"
+        "early(n) { if(n > 0, return(n)), 0 - 1 }\n"
+        "guarded() { try(return(5), Exception, 6), 7 }\n"
+        "a = find((1, 2, 3), 2)\n"
+        "b = find((1, 2, 3), 5)\n"
+        "c = early(7)\n"
+        "d = early(0)\n"
+        "e = guarded()\n"
+        "f = while(true, break(42))\n"
+    );
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "_this", scope)));
+    TEST(!Fuga_isRaised(FugaCode_evalIn(code, scope)));
+    TEST(FugaInt_is_(Fuga_getS(scope, "a"), 20));
+    TEST(FugaInt_is_(Fuga_getS(scope, "b"), 0));
+    TEST(FugaInt_is_(Fuga_getS(scope, "c"), 7));
+    TEST(FugaInt_is_(Fuga_getS(scope, "d"), -1));
+    TEST(FugaInt_is_(Fuga_getS(scope, "e"), 5));
+    TEST(FugaInt_is_(Fuga_getS(scope, "f"), 42));
+    TEST(!FUGA->unwind.value);
+
+    FugaParser_readCode_(parser, "return(1)");
+    code = FugaParser_block(parser);
+    TEST(Fuga_isRaised(FugaCode_evalIn(code, scope)));
+
+    Fuga_quit(self);
+}
+#endif
+
+/**
+ * Collections: `Object at`, `Object iter`, `Object empty`, `range` and
+ * `Object map`. They used to be written in Fuga, in prelude.fg, which
+ * keeps what they do as their documentation.
+ *
+ * An iterator (FUGA->Iter) holds an object and an index. It asks the
+ * object for its `len` and `at(index)`, and when those are Object's (or a
+ * range's) it reads the slots (or works out the int) itself. A range
+ * (FUGA->Range) is its start, step and len, and its one slot is `len`,
+ * as it was when ranges were written in Fuga. `map` goes through `iter`,
+ * `done?`, `value`, `next!`, `empty` and `append!` by sending them,
+ * unless they're the ones defined here, and it works out which of them
+ * are once, before the first element.
+ */
+
+typedef struct {
+    long start;
+    long end;
+    long step;      // 0 for range(start, end), where at(n) is start + n
+    long length;
+} FugaRange;
+
+typedef struct {
+    void* object;
+    long  index;
+} FugaIter;
+
+const FugaType FugaRange_type = {"Range"};
+const FugaType FugaIter_type  = {"Iter"};
+
+static void FugaIter_mark(void* _self)
+{
+    FugaIter* self = _self;
+    Fuga_mark_(self, self->object);
+}
+
+// Does `x` get the slot `name` from `proto`, rather than its own?
+static bool FugaPrelude_inherits(void* self, void* x, void* proto,
+                                 const char* name)
+{
+    void* value = Fuga_getS(x, name);
+    return !Fuga_isRaised(value) && value == Fuga_getS(proto, name);
+}
+
+// Where an iterator over `object` gets its values from.
+typedef enum {
+    FUGA_ITER_SEND,     // sends of len and at
+    FUGA_ITER_SLOTS,    // the object's slots, for Object's len and at
+    FUGA_ITER_RANGE     // a range's start and step, for Range's at
+} FugaIterKind;
+
+static FugaIterKind FugaIter_kind(void* self, void* object)
+{
+    if (Fuga_hasType_(object, &FugaRange_type)
+            && FugaPrelude_inherits(self, object, FUGA->Range, "at")) {
+        void* len = Fuga_getS(object, "len");
+        if (Fuga_isInt(len)
+                && FugaInt_value(len) == ((FugaRange*)object)->length)
+            return FUGA_ITER_RANGE;
+    }
+    if (FugaPrelude_inherits(self, object, FUGA->Object, "len")
+            && FugaPrelude_inherits(self, object, FUGA->Object, "at"))
+        return FUGA_ITER_SLOTS;
+    return FUGA_ITER_SEND;
+}
+
+void* FugaPrelude_at(void* self, void* index)
+{
+    ALWAYS(self); ALWAYS(index);
+    FUGA_NEED(self); FUGA_NEED(index);
+    if (!Fuga_isInt(index))
+        FUGA_RAISE(FUGA->TypeError, "at: expected index to be an integer");
+    return Fuga_get(self, index);
+}
+
+void* FugaPrelude_empty(void* self)
+{
+    ALWAYS(self);
+    return Fuga_clone(FUGA->Object);
+}
+
+static void* FugaIter_new(void* self, void* object, long index)
+{
+    FugaIter* iter = Fuga_clone_(FUGA->Iter, sizeof(FugaIter));
+    Fuga_type_(iter, &FugaIter_type);
+    Fuga_onMark_(iter, FugaIter_mark);
+    iter->object = object;
+    iter->index  = index;
+    return iter;
+}
+
+void* FugaPrelude_iter(void* self)
+{
+    ALWAYS(self);
+    FUGA_NEED(self);
+    return FugaIter_new(self, self, 0);
+}
+
+void* FugaIter_iter(void* _self)
+{
+    FugaIter* self = _self;
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (!Fuga_hasType_(self, &FugaIter_type))
+        FUGA_RAISE(FUGA->TypeError, "Iter iter: expected an iterator");
+    return FugaIter_new(self, self->object, self->index);
+}
+
+static void* FugaIter_doneAs(FugaIter* self, FugaIterKind kind)
+{
+    void* object = self->object;
+    long length;
+    switch (kind) {
+    case FUGA_ITER_RANGE:
+        length = ((FugaRange*)object)->length;
+        break;
+    case FUGA_ITER_SLOTS:
+        length = Fuga_length(object);
+        break;
+    default: {
+        void* len = Fuga_sendN(object, FUGA_SYMBOL("len"), 0, NULL);
+        FUGA_NEED(len);
+        return FugaInt_ge(FUGA_INT(self->index), len);
+    }
+    }
+    return FUGA_BOOL(self->index >= length);
+}
+
+static void* FugaIter_valueAs(FugaIter* self, FugaIterKind kind)
+{
+    void* object = self->object;
+    FugaRange* range = object;
+    switch (kind) {
+    case FUGA_ITER_RANGE:
+        return FUGA_INT(range->start + (range->step
+                                        ? self->index * range->step
+                                        : self->index));
+    case FUGA_ITER_SLOTS:
+        return Fuga_getI(object, self->index);
+    default: {
+        void* index = FUGA_INT(self->index);
+        return Fuga_sendN(object, FUGA_SYMBOL("at"), 1, &index);
+    }
+    }
+}
+
+void* FugaIter_done(void* _self)
+{
+    FugaIter* self = _self;
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (!Fuga_hasType_(self, &FugaIter_type))
+        FUGA_RAISE(FUGA->TypeError, "Iter done?: expected an iterator");
+    return FugaIter_doneAs(self, FugaIter_kind(self, self->object));
+}
+
+void* FugaIter_value(void* _self)
+{
+    FugaIter* self = _self;
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (!Fuga_hasType_(self, &FugaIter_type))
+        FUGA_RAISE(FUGA->TypeError, "Iter value: expected an iterator");
+    return FugaIter_valueAs(self, FugaIter_kind(self, self->object));
+}
+
+void* FugaIter_next(void* _self)
+{
+    FugaIter* self = _self;
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (!Fuga_hasType_(self, &FugaIter_type))
+        FUGA_RAISE(FUGA->TypeError, "Iter next!: expected an iterator");
+    self->index++;
+    return FUGA->nil;
+}
+
+void* FugaPrelude_range(void* self, void* args)
+{
+    ALWAYS(self); ALWAYS(args);
+    FUGA_NEED(args);
+    long argc = Fuga_length(args);
+    if (argc != 2 && argc != 3)
+        FUGA_RAISE(FUGA->TypeError, "range: expected 2 or 3 arguments");
+    void* argv[3];
+    for (long i = 0; i < argc; i++) {
+        argv[i] = Fuga_getI(args, i);
+        FUGA_NEED(argv[i]);
+    }
+    void* length = FugaInt_sub(argv[1], argv[0]);
+    if (argc == 3) {
+        FUGA_CHECK(length);
+        void* step = FugaInt_sub(argv[2], FUGA_INT(1));
+        FUGA_CHECK(step);
+        length = FugaInt_fdiv(FugaInt_add(length, step), argv[2]);
+    }
+    FUGA_CHECK(length);
+
+    FugaRange* range = Fuga_clone_(FUGA->Range, sizeof(FugaRange));
+    Fuga_type_(range, &FugaRange_type);
+    range->start  = FugaInt_value(argv[0]);
+    range->end    = FugaInt_value(argv[1]);
+    range->step   = argc == 3 ? FugaInt_value(argv[2]) : 0;
+    range->length = FugaInt_value(length);
+    FUGA_CHECK(Fuga_setS(range, "len", length));
+    return range;
+}
+
+void* FugaRange_at(void* _self, void* index)
+{
+    FugaRange* self = _self;
+    ALWAYS(self); ALWAYS(index);
+    FUGA_NEED(self); FUGA_NEED(index);
+    if (!Fuga_hasType_(self, &FugaRange_type))
+        FUGA_RAISE(FUGA->TypeError, "Range at: expected a range");
+    if (!Fuga_isInt(index))
+        FUGA_RAISE(FUGA->TypeError, "at: expected index to be an integer");
+    long n = FugaInt_value(index);
+    return FUGA_INT(self->start + (self->step ? n * self->step : n));
+}
+
+void* FugaRange_str(void* _self)
+{
+    FugaRange* self = _self;
+    ALWAYS(self);
+    FUGA_NEED(self);
+    if (!Fuga_hasType_(self, &FugaRange_type))
+        return FUGA_STRING("Range");
+    char buffer[80];
+    if (self->step)
+        sprintf(buffer, "range(%ld, %ld, %ld)",
+                self->start, self->end, self->step);
+    else
+        sprintf(buffer, "range(%ld, %ld)", self->start, self->end);
+    return FUGA_STRING(buffer);
+}
+
+/**
+ * `map(body)` evaluates body with each item as its receiver, and
+ * `map(x, body)` binds x to each item, in a clone of the scope map was
+ * called from made for that item, so that what the body makes (methods,
+ * say) keeps the item it was made with.
+ */
+void* FugaPrelude_map(void* self, void* args)
+{
+    ALWAYS(self); ALWAYS(args);
+    FUGA_NEED(self);
+    void* scope = Fuga_lazyScope(args);
+    void* code  = Fuga_lazyCode(args);
+    FUGA_CHECK(scope); FUGA_CHECK(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "map: expected unevaluated code");
+    long length = Fuga_length(code);
+    if (length != 1 && length != 2)
+        FUGA_RAISE(FUGA->TypeError, "map: expected 1 or 2 arguments");
+    void* name = length == 2 ? Fuga_getI(code, 0) : NULL;
+    void* body = Fuga_getI(code, length - 1);
+
+    void* iter   = Fuga_sendN(self, FUGA_SYMBOL("iter"), 0, NULL);
+    void* result = Fuga_sendN(self, FUGA_SYMBOL("empty"), 0, NULL);
+    FUGA_NEED(iter); FUGA_NEED(result);
+    // Only an iterator of our own, with nothing of its own, is stepped
+    // through without sends, and what it steps through is looked at once.
+    bool native = Fuga_hasType_(iter, &FugaIter_type)
+               && !Fuga_length(iter) && !FUGA_HEADER(iter)->slots;
+    FugaIterKind kind = native ? FugaIter_kind(self, ((FugaIter*)iter)->object)
+                               : FUGA_ITER_SEND;
+    bool appends = FugaPrelude_inherits(self, result, FUGA->Object,
+                                        "append!");
+    void* done  = FUGA_SYMBOL("done?");
+    void* value = FUGA_SYMBOL("value");
+    void* next  = FUGA_SYMBOL("next!");
+    void* append = FUGA_SYMBOL("append!");
+    while (true) {
+        void* test = native ? FugaIter_doneAs(iter, kind)
+                            : Fuga_sendN(iter, done, 0, NULL);
+        FUGA_NEED(test);
+        if (Fuga_isTrue(test))
+            return result;
+        if (!Fuga_isFalse(test))
+            FUGA_RAISE(FUGA->TypeError, "map: expected done? to be boolean");
+        void* item = native ? FugaIter_valueAs(iter, kind)
+                            : Fuga_sendN(iter, value, 0, NULL);
+        FUGA_CHECK(item);
+        if (name) {
+            void* inner = Fuga_clone(scope);
+            FUGA_CHECK(Fuga_set(inner, name, item));
+            item = Fuga_eval(body, inner, inner);
+        } else {
+            item = Fuga_eval(body, item, scope);
+        }
+        FUGA_CHECK(item);
+        if (appends)
+            FUGA_CHECK(Fuga_append_(result, item));
+        else
+            FUGA_CHECK(Fuga_sendN(result, append, 1, &item));
+        if (native)
+            ((FugaIter*)iter)->index++;
+        else
+            FUGA_CHECK(Fuga_sendN(iter, next, 0, NULL));
+    }
+}
+
+#ifdef TESTING
+TESTS(FugaPrelude_map) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "a = (1, 2, 3) map(*2)\n"
+        "b = (1, 2, 3) map(x, x * 10)\n"
+        "c = range(0, 5) map(x, x * x)\n"
+        "d = range(1, 10, 3) map(+0)\n"
+        "e = range(5, 0) map(x, x)\n"
+        "n = 0\n"
+        "for(x, range(0, 4), n := [n + x])\n"
+        "i = (7, 8) iter\n"
+        "j = i iter\n"
+        "i next!\n"
+        "f = (i value, j value, i done?, (7, 8) at(-1))\n"
+        "g = (x = 1, 2) empty len\n"
+        "h = range(0, 10, 3) len\n"
+        "k = range(2, 9) at(3)\n"
+        "r = range(0, 3) get(:len)\n"
+        "s = range(0, 5), s len = 2\n"
+        "t = s map(+0)\n"
+        "fs = (1, 2, 3) map(x, method((), x))\n"
+        "p = fs at(0), q = fs at(2)\n"
+        "l = (p(), q())\n"
+    );
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "_this", scope)));
+    TEST(!Fuga_isRaised(FugaCode_evalIn(code, scope)));
+
+    void* a = Fuga_getS(scope, "a");
+    TEST(Fuga_hasLength_(a, 3) && FugaInt_is_(Fuga_getI(a, 2), 6));
+    void* b = Fuga_getS(scope, "b");
+    TEST(Fuga_hasLength_(b, 3) && FugaInt_is_(Fuga_getI(b, 0), 10));
+    void* c = Fuga_getS(scope, "c");
+    TEST(Fuga_hasLength_(c, 5) && FugaInt_is_(Fuga_getI(c, 4), 16));
+    void* d = Fuga_getS(scope, "d");
+    TEST(Fuga_hasLength_(d, 3) && FugaInt_is_(Fuga_getI(d, 2), 7));
+    TEST(Fuga_hasLength_(Fuga_getS(scope, "e"), 0));
+    TEST(FugaInt_is_(Fuga_getS(scope, "n"), 6));
+    void* f = Fuga_getS(scope, "f");
+    TEST(FugaInt_is_(Fuga_getI(f, 0), 8));
+    TEST(FugaInt_is_(Fuga_getI(f, 1), 7));
+    TEST(Fuga_getI(f, 2) == FUGA->False);
+    TEST(FugaInt_is_(Fuga_getI(f, 3), 8));
+    TEST(FugaInt_is_(Fuga_getS(scope, "g"), 0));
+    TEST(FugaInt_is_(Fuga_getS(scope, "h"), 4));
+    TEST(FugaInt_is_(Fuga_getS(scope, "k"), 5));
+    TEST(FugaInt_is_(Fuga_getS(scope, "r"), 3));
+    TEST(Fuga_hasLength_(Fuga_getS(scope, "t"), 2));
+    void* l = Fuga_getS(scope, "l");
+    TEST(FugaInt_is_(Fuga_getI(l, 0), 1) && FugaInt_is_(Fuga_getI(l, 1), 3));
+
+    // errors, and objects with iterators of their own.
+    TEST(Fuga_isRaised(FugaPrelude_at(FUGA->Object, FUGA_STRING("x"))));
+    void* args = Fuga_clone(FUGA->Object);
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(0))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(5))));
+    TEST(!Fuga_isRaised(Fuga_append_(args, FUGA_INT(0))));
+    TEST(Fuga_isRaised(FugaPrelude_range(self, args)));
+    FugaParser_readCode_(parser,
+        "Counter = (n = 3)\n"
+        "Counter iter { (c = self n\n"
+        "                done? { self c == 0 }\n"
+        "                value { self c }\n"
+        "                next! { self c := [self c - 1] }) }\n"
+        "m = Counter map(*1)\n"
+    );
+    code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(FugaCode_evalIn(code, scope)));
+    void* m = Fuga_getS(scope, "m");
+    TEST(Fuga_hasLength_(m, 3) && FugaInt_is_(Fuga_getI(m, 0), 3)
+                               && FugaInt_is_(Fuga_getI(m, 2), 1));
+
+    Fuga_quit(self);
+}
+#endif
+
 void* FugaPrelude_method(
     void* self,
     void* args
@@ -408,7 +1195,7 @@ void* FugaPrelude_match(
         void* result = Fuga_match_(matcher, value);
         bool matched = true;
         FUGA_TRY(result) {
-            FUGA_CATCH(FUGA->MatchError) {
+            FUGA_CATCH_NO_MATCH {
                 matched = false;
                 break;
             }
@@ -430,19 +1217,18 @@ void* FugaPrelude_match(
 
 void* FugaPrelude_do(
     void* self,
-    void* args
+    void* code,
+    void* scope,
+    bool tail
 ) {
-    ALWAYS(self); ALWAYS(args);
-    void* scope = Fuga_lazyScope(args);
-    void* code  = Fuga_lazyCode(args);
-    FUGA_CHECK(scope); FUGA_CHECK(code);
+    ALWAYS(self); ALWAYS(code);
+    if (!scope)
+        FUGA_RAISE(FUGA->TypeError, "do: expected unevaluated code");
     scope = Fuga_clone(scope);
     FUGA_CHECK(Fuga_setS(scope, "_this", scope));
-
-    void* result = FUGA->nil;
-    FUGA_FOR(i, slot, code)
-        FUGA_CHECK(result = Fuga_eval(slot, scope, scope));
-    return result;
+    if (tail)
+        return FugaCode_evalDoTail(code, scope);
+    return FugaCode_evalDo(code, scope);
 }
 
 void* FugaPrelude_def(
@@ -637,8 +1423,14 @@ void* FugaPrelude_try(void* self, void* args) {
 
     long length = Fuga_length(args);
     void* value = Fuga_need(Fuga_getI(args, 0));
-    if (Fuga_isRaised(value)) {
+    if (Fuga_isRaised(value) && !Fuga_isUnwind(Fuga_catch(value))) {
         void* error = Fuga_catch(value);
+        // NoMatch is shared by every failed match: a handler gets a
+        // MatchError of its own, or it could change the next one's.
+        if (error == FUGA->NoMatch) {
+            error = Fuga_clone(FUGA->MatchError);
+            FUGA_CHECK(Fuga_setS(error, "msg", FUGA_STRING("no match")));
+        }
         for (int i = 1; i < length-1; i+=2) {
             void* proto = Fuga_getI(args, i);
             FUGA_NEED(proto);
@@ -659,3 +1451,31 @@ void* FugaPrelude_try(void* self, void* args) {
     return value;
 }
 
+#ifdef TESTING
+TESTS(FugaPrelude_try) {
+    void* self  = Fuga_init();
+    void* scope = Fuga_clone(FUGA->Prelude);
+    FugaParser* parser = FugaParser_new(self);
+    FugaParser_readCode_(parser,
+        "a = try(1 match(2), Exception, exception)\n"
+        "b = try(\"x\" match(\"y\"), Exception, exception)\n"
+        "a foo = 1\n"
+    );
+    void* code = FugaParser_block(parser);
+    TEST(!Fuga_isRaised(code));
+    TEST(!Fuga_isRaised(Fuga_setS(scope, "_this", scope)));
+    TEST(!Fuga_isRaised(FugaCode_evalIn(code, scope)));
+    void* a = Fuga_getS(scope, "a");
+    void* b = Fuga_getS(scope, "b");
+    TEST(a != b && a != FUGA->NoMatch && b != FUGA->NoMatch);
+    TEST(Fuga_isa_(a, FUGA->MatchError));
+    TEST(Fuga_isa_(b, FUGA->MatchError));
+    TEST(Fuga_isTrue(Fuga_hasS(a, "foo")));
+    TEST(Fuga_isFalse(Fuga_hasS(b, "foo")));
+    TEST(Fuga_isFalse(Fuga_hasS(FUGA->NoMatch, "foo")));
+    TEST(Fuga_isa_(Fuga_getS(b, "msg"), FUGA->String));
+
+    Fuga_quit(self);
+}
+#endif
+
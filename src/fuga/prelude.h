@@ -6,12 +6,12 @@
 void  FugaPrelude_init    (void*);
 void* FugaPrelude_equals  (void* self, void* args);
 void* FugaPrelude_modify  (void* self, void* args);
-void* FugaPrelude_if      (void* self, void* args);
+void* FugaPrelude_if      (void* self, void* code, void* scope, bool tail);
 void* FugaPrelude_method  (void* self, void* args);
 void* FugaPrelude_print   (void* self, void* args);
 void* FugaPrelude_import  (void* self, void* args);
 void* FugaPrelude_match   (void* self, void* args);
-void* FugaPrelude_do      (void* self, void* args);
+void* FugaPrelude_do      (void* self, void* code, void* scope, bool tail);
 void* FugaPrelude_def     (void* self, void* args);
 void* FugaPrelude_help    (void* self, void* args);
 void* FugaPrelude_try     (void* self, void* args);
@@ -19,9 +19,30 @@ void* FugaPrelude_try     (void* self, void* args);
 void* FugaPrelude_is  (void* self, void* a, void* b);
 void* FugaPrelude_isa (void* self, void* a, void* b);
 
-void* FugaPrelude_orM     (void* self, void* args);
-void* FugaPrelude_andM    (void* self, void* args);
+void* FugaPrelude_orM     (void* self, void* code, void* scope, bool tail);
+void* FugaPrelude_andM    (void* self, void* code, void* scope, bool tail);
 void* FugaPrelude_notM    (void* self, void* arg);
 
+void* FugaPrelude_while   (void* self, void* code, void* scope, bool tail);
+void* FugaPrelude_for     (void* self, void* code, void* scope, bool tail);
+void* FugaPrelude_times   (void* self, void* code, void* scope, bool tail);
+void* FugaPrelude_break   (void* self, void* code, void* scope, bool tail);
+void* FugaPrelude_continue(void* self, void* code, void* scope, bool tail);
+void* FugaPrelude_return  (void* self, void* code, void* scope, bool tail);
+
+void* FugaPrelude_at      (void* self, void* index);
+void* FugaPrelude_iter    (void* self);
+void* FugaPrelude_empty   (void* self);
+void* FugaPrelude_range   (void* self, void* args);
+void* FugaPrelude_map     (void* self, void* args);
+
+void* FugaIter_iter       (void* self);
+void* FugaIter_done       (void* self);
+void* FugaIter_value      (void* self);
+void* FugaIter_next       (void* self);
+
+void* FugaRange_at        (void* self, void* index);
+void* FugaRange_str       (void* self);
+
 #endif
 
@@ -3,42 +3,565 @@
 #include "test.h"
 #include "fuga.h"
 
+#include <string.h>
+
 /**
 *** # FugaSlots
 *** ### FugaSlots
+***
+*** Slots are stored in two parts, like Lua tables:
+***
+*** - the *array part* holds the values of unnamed slots, in order, so a
+***   list costs one pointer per element;
+*** - the *hash part* holds the named slots, in order, as (name, value)
+***   entries. Once there are more than `FUGA_SLOTS_SCAN` names, a bucket
+***   table of entry positions is kept next to the entries so lookups
+***   don't have to scan.
+***
+*** As long as every named slot comes before every unnamed slot, slot `i`
+*** is entry `i` if `i < hashLength`, and array element `i - hashLength`
+*** otherwise. When the two interleave, the `order` vector maps each index
+*** to its part (`FUGA_SLOTS_ARRAY` bit) and position within that part.
+***
+*** Documentation is rare, so it is kept out of both parts, in a side
+*** table of (index, doc) pairs sorted by index. `docs` is NULL when no
+*** slot has documentation, which is all `FugaSlots_hasDocs` checks.
+***
+*** Each part lives in its own reference-counted buffer. `FugaSlots_copy`
+*** shares the buffers, and every write goes through `FugaSlots_own`,
+*** which duplicates any shared buffers in one go. Shared buffers are
+*** therefore never written to.
+***
+*** A FugaSlots embedded in an object (see `FugaSlots_embed`) also has a
+*** `small` buffer of `FUGA_SLOTS_SMALL` words in the same allocation. The
+*** first part to need storage takes it, and moves out to a buffer of its
+*** own once it outgrows it. The small buffer has a reference count of 0:
+*** it is never shared or freed, and copies get a buffer of their own.
+***
+*** The compiled form of a code object (see `FugaCode`) is kept with its
+*** slots, in one more reference-counted buffer, `code`. Copies share it,
+*** and `FugaSlots_own` drops it, since any write may change what the
+*** code means.
 **/
+typedef struct FugaSlotEntry FugaSlotEntry;
+struct FugaSlotEntry {
+    void* name;
+    void* value;
+};
+
+typedef struct FugaSlotDoc FugaSlotDoc;
+struct FugaSlotDoc {
+    FugaIndex index;
+    void* doc;
+};
+
 struct FugaSlots {
     size_t length;
+    size_t arrayLength;
+    size_t hashLength;
+    size_t docsLength;
+    void** array;
+    FugaSlotEntry* entries;
+    FugaSlotDoc* docs;
+    uint32_t* buckets;
+    uint32_t* order;
+    void* small;
+    void* code;
+    size_t writes;
+};
+
+#define FUGA_SLOTS_SCAN     8
+#define FUGA_SLOTS_ARRAY    0x80000000u
+#define FUGA_SLOTS_SMALL    6
+
+/**
+*** ### FugaSlotsBuffer
+***
+*** The header in front of each part. `capacity` is in elements. `refs`
+*** is 0 for the small buffer of an embedded FugaSlots.
+**/
+typedef struct FugaSlotsBuffer FugaSlotsBuffer;
+struct FugaSlotsBuffer {
+    size_t refs;
     size_t capacity;
-    FugaSlot* slots;
 };
 
+/**
+*** ### FugaSlotsEmbedded
+***
+*** What `FugaSlots_embed` puts in front of an object's header.
+**/
+typedef struct FugaSlotsEmbedded FugaSlotsEmbedded;
+struct FugaSlotsEmbedded {
+    FugaHeader header;
+    FugaSlots slots;
+    FugaSlotsBuffer buffer;
+    void* small[FUGA_SLOTS_SMALL];
+};
+
+const size_t FugaSlots_embedSize = sizeof(FugaSlotsEmbedded);
+
+#define FUGA_SLOTS_BUFFER(p)   (((FugaSlotsBuffer*)(p))-1)
+#define FUGA_SLOTS_CAPACITY(p) ((p) ? FUGA_SLOTS_BUFFER(p)->capacity : 0)
+
+static void* FugaSlotsBuffer_new(size_t capacity, size_t size) {
+    FugaSlotsBuffer* buffer = calloc(1, sizeof(FugaSlotsBuffer)
+                                      + capacity * size);
+    buffer->refs     = 1;
+    buffer->capacity = capacity;
+    return buffer+1;
+}
+
+static void FugaSlotsBuffer_free(void* self) {
+    if (self && FUGA_SLOTS_BUFFER(self)->refs &&
+        --FUGA_SLOTS_BUFFER(self)->refs == 0)
+        free(FUGA_SLOTS_BUFFER(self));
+}
+
+static void* FugaSlotsBuffer_share(void* self) {
+    if (self) {
+        ALWAYS(FUGA_SLOTS_BUFFER(self)->refs);
+        FUGA_SLOTS_BUFFER(self)->refs++;
+    }
+    return self;
+}
+
+/**
+*** Return an unshared version of a buffer, copying the first `length`
+*** elements if the buffer was shared.
+**/
+static void* FugaSlotsBuffer_own(void* self, size_t length, size_t size) {
+    if (!self || FUGA_SLOTS_BUFFER(self)->refs <= 1)
+        return self;
+    void* result = FugaSlotsBuffer_new(FUGA_SLOTS_BUFFER(self)->capacity,
+                                       size);
+    memcpy(result, self, length * size);
+    FUGA_SLOTS_BUFFER(self)->refs--;
+    return result;
+}
+
+/**
+*** Grow an unshared buffer to exactly `newCapacity` elements. New elements
+*** are zeroed.
+**/
+static void* FugaSlotsBuffer_resize(
+    void* self,
+    size_t newCapacity,
+    size_t size
+) {
+    if (!self)
+        return FugaSlotsBuffer_new(newCapacity, size);
+    size_t capacity = FUGA_SLOTS_CAPACITY(self);
+    if (!FUGA_SLOTS_BUFFER(self)->refs) {
+        void* result = FugaSlotsBuffer_new(newCapacity, size);
+        memcpy(result, self, capacity * size);
+        return result;
+    }
+    FugaSlotsBuffer* buffer = realloc(FUGA_SLOTS_BUFFER(self),
+        sizeof(FugaSlotsBuffer) + newCapacity * size);
+    memset((char*)(buffer+1) + capacity*size, 0,
+           (newCapacity - capacity) * size);
+    buffer->capacity = newCapacity;
+    return buffer+1;
+}
+
+/**
+*** Make room for at least `needed` elements in an unshared buffer,
+*** doubling the capacity (starting from 4) as necessary.
+**/
+static void* FugaSlotsBuffer_reserve(void* self, size_t needed, size_t size) {
+    size_t capacity = FUGA_SLOTS_CAPACITY(self);
+    if (needed <= capacity)
+        return self;
+    if (!self)
+        return FugaSlotsBuffer_new(needed > 4 ? needed : 4, size);
+    size_t newCapacity = capacity;
+    while (newCapacity < needed)
+        newCapacity *= 2;
+    return FugaSlotsBuffer_resize(self, newCapacity, size);
+}
+
 void FugaSlots_free(void* _self) {
     FugaSlots* self = _self;
-    free(self->slots);
+    FugaSlotsBuffer_free(self->array);
+    FugaSlotsBuffer_free(self->entries);
+    FugaSlotsBuffer_free(self->docs);
+    FugaSlotsBuffer_free(self->buckets);
+    FugaSlotsBuffer_free(self->order);
+    FugaSlotsBuffer_free(self->code);
 }
 
 void FugaSlots_mark(void* _self) {
     FugaSlots* self = _self;
-    for (FugaIndex i = 0; i < self->length; i++) {
-        Fuga_mark_(self, self->slots[i].name);
-        Fuga_mark_(self, self->slots[i].value);
-        Fuga_mark_(self, self->slots[i].doc);
+    for (size_t i = 0; i < self->arrayLength; i++)
+        Fuga_mark_(self, self->array[i]);
+    for (size_t i = 0; i < self->hashLength; i++) {
+        Fuga_mark_(self, self->entries[i].name);
+        Fuga_mark_(self, self->entries[i].value);
     }
+    for (size_t i = 0; i < self->docsLength; i++)
+        Fuga_mark_(self, self->docs[i].doc);
 }
 
 FugaSlots* FugaSlots_new(void* self) {
     ALWAYS(self);
     FugaSlots* result = Fuga_clone_(FUGA->Object, sizeof(FugaSlots));
-    result->length   = 0;
-    result->capacity = 4;
-    result->slots    = calloc(result->capacity, sizeof(FugaSlot));
     Fuga_onMark_(result, FugaSlots_mark);
     Fuga_onFree_(result, FugaSlots_free);
     FUGA_HEADER(result)->slots = result;
     return result;
 }
 
+/**
+*** ### FugaSlots_embed
+***
+*** Set up the FugaSlots that lives in `block`, in front of the header of
+*** `self`. It has no place in the GC lists: marking it marks `self`, and
+*** `self` takes care of marking and freeing it.
+**/
+FugaSlots* FugaSlots_embed(void* self, void* block) {
+    ALWAYS(self); ALWAYS(block);
+    FugaSlotsEmbedded* embedded = block;
+    FugaHeader* header = &embedded->header;
+    header->root  = FUGA;
+    header->proto = FUGA->Object;
+    header->slots = &embedded->slots;
+    header->gc.embedded = true;
+    header->gc.mark = FugaSlots_mark;
+    header->gc.free = FugaSlots_free;
+    FugaGCList_init(&header->gc.list);
+    embedded->slots.small = embedded->small;
+    return &embedded->slots;
+}
+
+/**
+*** ### FugaSlots_grow
+***
+*** Make room for `needed` elements in a part, starting out in the small
+*** buffer if the part is empty and the small buffer is free.
+*** `FugaSlots_fit` does the same, but without leaving room to spare.
+**/
+static void* FugaSlots_takeSmall(
+    FugaSlots* self,
+    void* part,
+    size_t needed,
+    size_t size
+) {
+    if (!part && needed && self->small &&
+        needed * size <= FUGA_SLOTS_SMALL * sizeof(void*) &&
+        self->array != self->small && self->entries != self->small) {
+        part = self->small;
+        FUGA_SLOTS_BUFFER(part)->capacity = FUGA_SLOTS_SMALL * sizeof(void*)
+                                          / size;
+    }
+    return part;
+}
+
+static void* FugaSlots_grow(
+    FugaSlots* self,
+    void* part,
+    size_t needed,
+    size_t size
+) {
+    part = FugaSlots_takeSmall(self, part, needed, size);
+    return FugaSlotsBuffer_reserve(part, needed, size);
+}
+
+static void* FugaSlots_fit(
+    FugaSlots* self,
+    void* part,
+    size_t needed,
+    size_t size
+) {
+    part = FugaSlots_takeSmall(self, part, needed, size);
+    if (needed <= FUGA_SLOTS_CAPACITY(part))
+        return part;
+    return FugaSlotsBuffer_resize(part, needed, size);
+}
+
+/**
+*** Share a part of another FugaSlots: the same buffer, unless it is a
+*** small buffer, in which case the first `length` elements are copied.
+**/
+static void* FugaSlots_sharePart(
+    FugaSlots* self,
+    void* part,
+    size_t length,
+    size_t size
+) {
+    if (!part || FUGA_SLOTS_BUFFER(part)->refs)
+        return FugaSlotsBuffer_share(part);
+    void* result = FugaSlots_grow(self, NULL, length, size);
+    if (length)
+        memcpy(result, part, length * size);
+    return result;
+}
+
+/**
+*** ### FugaSlots_share_
+***
+*** Replace the slots of `self` by those of `other`, in O(1). The two share
+*** their buffers until one of them is written to.
+**/
+void FugaSlots_share_(FugaSlots* self, FugaSlots* other) {
+    ALWAYS(self); ALWAYS(other);
+    if (self == other)
+        return;
+    void* small = self->small;
+    size_t writes = self->writes;
+    FugaSlots_free(self);
+    *self = *other;
+    self->small = small;
+    self->writes = writes + 1;
+    self->array   = NULL;
+    self->entries = NULL;
+    self->array   = FugaSlots_sharePart(self, other->array,
+                        other->arrayLength, sizeof(void*));
+    self->entries = FugaSlots_sharePart(self, other->entries,
+                        other->hashLength, sizeof(FugaSlotEntry));
+    FugaSlotsBuffer_share(self->docs);
+    FugaSlotsBuffer_share(self->buckets);
+    FugaSlotsBuffer_share(self->order);
+    FugaSlotsBuffer_share(self->code);
+}
+
+/**
+*** ### FugaSlots_copy
+***
+*** Create a FugaSlots with the same slots as `self`. This is O(1): the
+*** two share their buffers until one of them is written to.
+**/
+FugaSlots* FugaSlots_copy(FugaSlots* self) {
+    ALWAYS(self);
+    FugaSlots* result = FugaSlots_new(self);
+    FugaSlots_share_(result, self);
+    return result;
+}
+
+/**
+*** ### FugaSlots_own
+***
+*** Make sure `self` is the only user of its buffers, duplicating any
+*** that are shared, drop the compiled code, and count the write. Called
+*** before every write.
+**/
+static void FugaSlots_own(FugaSlots* self) {
+    self->writes++;
+    FugaSlotsBuffer_free(self->code);
+    self->code      = NULL;
+    self->array     = FugaSlotsBuffer_own(self->array, self->arrayLength,
+                                          sizeof(void*));
+    self->entries   = FugaSlotsBuffer_own(self->entries, self->hashLength,
+                                          sizeof(FugaSlotEntry));
+    self->docs      = FugaSlotsBuffer_own(self->docs, self->docsLength,
+                                          sizeof(FugaSlotDoc));
+    self->buckets   = FugaSlotsBuffer_own(self->buckets,
+                                          FUGA_SLOTS_CAPACITY(self->buckets),
+                                          sizeof(uint32_t));
+    self->order     = FugaSlotsBuffer_own(self->order, self->length,
+                                          sizeof(uint32_t));
+}
+
+/**
+*** ### FugaSlots_locate
+***
+*** Find the part (array or hash) and the position within that part of
+*** the slot with a given index.
+**/
+static bool FugaSlots_locate(
+    FugaSlots* self,
+    FugaIndex index,
+    bool* inArray,
+    size_t* position
+) {
+    if (index >= self->length)
+        return false;
+    if (self->order) {
+        *inArray  = self->order[index] & FUGA_SLOTS_ARRAY;
+        *position = self->order[index] & ~FUGA_SLOTS_ARRAY;
+    } else if (index < self->hashLength) {
+        *inArray  = false;
+        *position = index;
+    } else {
+        *inArray  = true;
+        *position = index - self->hashLength;
+    }
+    return true;
+}
+
+static size_t FugaSlots_hash(void* name, size_t mask) {
+    return (((uintptr_t)name >> 4) * 2654435761u) & mask;
+}
+
+static void FugaSlots_insertBucket(FugaSlots* self, size_t position) {
+    size_t mask = FUGA_SLOTS_CAPACITY(self->buckets) - 1;
+    size_t i = FugaSlots_hash(self->entries[position].name, mask);
+    while (self->buckets[i])
+        i = (i + 1) & mask;
+    self->buckets[i] = position + 1;
+}
+
+/**
+*** Rebuild the bucket table from the entries, with room for `names` names
+*** in all.
+**/
+static void FugaSlots_hashFor(FugaSlots* self, size_t names) {
+    FugaSlotsBuffer_free(self->buckets);
+    size_t capacity = 16;
+    while (capacity < 2 * names)
+        capacity *= 2;
+    self->buckets = FugaSlotsBuffer_new(capacity, sizeof(uint32_t));
+    for (size_t i = 0; i < self->hashLength; i++)
+        FugaSlots_insertBucket(self, i);
+}
+
+/**
+*** Rebuild the bucket table from the entries, or drop it if there are few
+*** enough names to scan.
+**/
+static void FugaSlots_rehash(FugaSlots* self) {
+    if (self->hashLength > FUGA_SLOTS_SCAN) {
+        FugaSlots_hashFor(self, self->hashLength);
+    } else {
+        FugaSlotsBuffer_free(self->buckets);
+        self->buckets = NULL;
+    }
+}
+
+/**
+*** Return the position of the entry with a given name, or -1.
+**/
+static long FugaSlots_find(FugaSlots* self, void* name) {
+    if (self->buckets) {
+        size_t mask = FUGA_SLOTS_CAPACITY(self->buckets) - 1;
+        size_t i = FugaSlots_hash(name, mask);
+        while (self->buckets[i]) {
+            long position = self->buckets[i] - 1;
+            if (self->entries[position].name == name)
+                return position;
+            i = (i + 1) & mask;
+        }
+        return -1;
+    }
+    for (size_t i = 0; i < self->hashLength; i++)
+        if (self->entries[i].name == name)
+            return i;
+    return -1;
+}
+
+/**
+*** Switch to the interleaved representation, by writing down the order
+*** implied by "named slots first".
+**/
+static void FugaSlots_buildOrder(FugaSlots* self) {
+    self->order = FugaSlotsBuffer_reserve(NULL, self->length + 1,
+                                          sizeof(uint32_t));
+    for (size_t i = 0; i < self->hashLength; i++)
+        self->order[i] = i;
+    for (size_t i = 0; i < self->arrayLength; i++)
+        self->order[self->hashLength + i] = i | FUGA_SLOTS_ARRAY;
+}
+
+static void FugaSlots_pushOrder(FugaSlots* self, uint32_t entry) {
+    self->order = FugaSlotsBuffer_reserve(self->order, self->length + 1,
+                                          sizeof(uint32_t));
+    self->order[self->length] = entry;
+}
+
+static void FugaSlots_appendUnnamed(FugaSlots* self, void* value) {
+    self->array = FugaSlots_grow(self, self->array, self->arrayLength + 1,
+                                 sizeof(void*));
+    if (self->order)
+        FugaSlots_pushOrder(self, self->arrayLength | FUGA_SLOTS_ARRAY);
+    self->array[self->arrayLength++] = value;
+    self->length++;
+}
+
+static void FugaSlots_appendNamed(FugaSlots* self, FugaSlot slot) {
+    if (self->arrayLength && !self->order)
+        FugaSlots_buildOrder(self);
+    if (self->order)
+        FugaSlots_pushOrder(self, self->hashLength);
+    self->entries = FugaSlots_grow(self, self->entries, self->hashLength + 1,
+                                   sizeof(FugaSlotEntry));
+    FugaSlotEntry entry = {.name = slot.name, .value = slot.value};
+    self->entries[self->hashLength++] = entry;
+    self->length++;
+    if (self->buckets &&
+        2 * self->hashLength <= FUGA_SLOTS_CAPACITY(self->buckets))
+        FugaSlots_insertBucket(self, self->hashLength - 1);
+    else if (self->hashLength > FUGA_SLOTS_SCAN)
+        FugaSlots_rehash(self);
+}
+
+/**
+*** Return the position in the doc table of the doc for a given index, or
+*** the position where it would be inserted, setting `found`.
+**/
+static size_t FugaSlots_findDoc(FugaSlots* self, FugaIndex index, bool* found) {
+    size_t lo = 0, hi = self->docsLength;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (self->docs[mid].index < index)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *found = lo < self->docsLength && self->docs[lo].index == index;
+    return lo;
+}
+
+static void* FugaSlots_docByIndex(FugaSlots* self, FugaIndex index) {
+    bool found;
+    size_t position = FugaSlots_findDoc(self, index, &found);
+    return found ? self->docs[position].doc : NULL;
+}
+
+/**
+*** Set (or, if `doc` is NULL, remove) the doc of a given index. When the
+*** last doc is removed, the table goes away, and with it the "has docs"
+*** flag.
+**/
+static void FugaSlots_putDoc(FugaSlots* self, FugaIndex index, void* doc) {
+    if (!self->docs && !doc)
+        return;
+    bool found;
+    size_t position = FugaSlots_findDoc(self, index, &found);
+    if (found && doc) {
+        self->docs[position].doc = doc;
+    } else if (found) {
+        memmove(self->docs + position, self->docs + position + 1,
+                (self->docsLength - position - 1) * sizeof(FugaSlotDoc));
+        if (--self->docsLength == 0) {
+            FugaSlotsBuffer_free(self->docs);
+            self->docs = NULL;
+        }
+    } else if (doc) {
+        self->docs = FugaSlotsBuffer_reserve(self->docs,
+                                             self->docsLength + 1,
+                                             sizeof(FugaSlotDoc));
+        memmove(self->docs + position + 1, self->docs + position,
+                (self->docsLength - position) * sizeof(FugaSlotDoc));
+        FugaSlotDoc entry = {.index = index, .doc = doc};
+        self->docs[position] = entry;
+        self->docsLength++;
+    }
+}
+
+/**
+*** Return the index of the named slot at a given position in the hash
+*** part.
+**/
+static FugaIndex FugaSlots_entryIndex(FugaSlots* self, size_t position) {
+    if (!self->order)
+        return position;
+    FugaIndex index;
+    for (index = 0; index < self->length; index++)
+        if (self->order[index] == (uint32_t)position)
+            break;
+    return index;
+}
+
 /**
 *** ## Properties
 *** ### FugaSlots_length
@@ -51,6 +574,61 @@ size_t FugaSlots_length(FugaSlots* self) {
     return self->length;
 }
 
+/**
+*** ### FugaSlots_hasDocs
+***
+*** Determine whether any slot has documentation.
+**/
+bool FugaSlots_hasDocs(FugaSlots* self) {
+    ALWAYS(self);
+    return self->docs != NULL;
+}
+
+/**
+*** ## Compiled Code
+*** ### FugaSlots_code
+***
+*** Return the compiled code kept with `self`, or NULL if there is none
+*** (or it has been dropped by a write since).
+**/
+void* FugaSlots_code(FugaSlots* self) {
+    ALWAYS(self);
+    return self->code;
+}
+
+size_t FugaSlots_writes(FugaSlots* self) {
+    ALWAYS(self);
+    return self->writes;
+}
+
+/**
+*** ### FugaSlots_code_
+***
+*** Replace the compiled code kept with `self` by `count` zeroed elements
+*** of `size` bytes, and return them to be filled in.
+**/
+void* FugaSlots_code_(FugaSlots* self, size_t count, size_t size) {
+    ALWAYS(self);
+    FugaSlotsBuffer_free(self->code);
+    self->code = FugaSlotsBuffer_new(count, size);
+    return self->code;
+}
+
+/**
+*** ### FugaSlots_retainCode
+*** ### FugaSlots_releaseCode
+***
+*** Keep compiled code alive while it runs, even if the slots it came
+*** from are written to (and drop it) in the meantime.
+**/
+void* FugaSlots_retainCode(void* code) {
+    return FugaSlotsBuffer_share(code);
+}
+
+void FugaSlots_releaseCode(void* code) {
+    FugaSlotsBuffer_free(code);
+}
+
 /**
 *** ## Has
 *** ### FugaSlots_hasByIndex
@@ -70,12 +648,7 @@ bool FugaSlots_hasByIndex(FugaSlots* self, FugaIndex index) {
 bool FugaSlots_hasBySymbol(FugaSlots* self, void* symbol) {
     ALWAYS(self);
     ALWAYS(symbol);
-    for (FugaIndex i = 0; i < self->length; i++) {
-        if (self->slots[i].name &&
-            Fuga_is_(self->slots[i].name, symbol))
-            return true;
-    }
-    return false;
+    return FugaSlots_find(self, symbol) >= 0;
 }
 
 /**
@@ -84,12 +657,22 @@ bool FugaSlots_hasBySymbol(FugaSlots* self, void* symbol) {
 ***
 *** Get the slot associated with a given index.
 **/
-FugaSlot* FugaSlots_getByIndex(FugaSlots* self, FugaIndex index) {
+FugaSlot FugaSlots_getByIndex(FugaSlots* self, FugaIndex index) {
     ALWAYS(self);
-    if (index < self->length)
-        return &self->slots[index];
-    else
-        return NULL;
+    FugaSlot slot = {.value = NULL, .name = NULL, .doc = NULL};
+    bool inArray;
+    size_t position;
+    if (FugaSlots_locate(self, index, &inArray, &position)) {
+        if (inArray) {
+            slot.value = self->array[position];
+        } else {
+            slot.value = self->entries[position].value;
+            slot.name  = self->entries[position].name;
+        }
+        if (self->docs)
+            slot.doc = FugaSlots_docByIndex(self, index);
+    }
+    return slot;
 }
 
 /**
@@ -97,15 +680,77 @@ FugaSlot* FugaSlots_getByIndex(FugaSlots* self, FugaIndex index) {
 ***
 *** Get the slot associated with a given symbol.
 **/
-FugaSlot* FugaSlots_getBySymbol(FugaSlots* self, void* symbol) {
+FugaSlot FugaSlots_getBySymbol(FugaSlots* self, void* symbol) {
     ALWAYS(self);
     ALWAYS(symbol);
-    for (FugaIndex i = 0; i < self->length; i++) {
-        if (self->slots[i].name &&
-            Fuga_is_(self->slots[i].name, symbol))
-            return &self->slots[i];
+    FugaSlot slot = {.value = NULL, .name = NULL, .doc = NULL};
+    long position = FugaSlots_find(self, symbol);
+    if (position >= 0) {
+        slot.value = self->entries[position].value;
+        slot.name  = self->entries[position].name;
+        if (self->docs)
+            slot.doc = FugaSlots_docByIndex(self,
+                           FugaSlots_entryIndex(self, position));
+    }
+    return slot;
+}
+
+/**
+*** ### FugaSlots_valueByIndex
+*** ### FugaSlots_valueBySymbol
+***
+*** Get just the value of a slot, or NULL if there's no such slot. Unlike
+*** `FugaSlots_getByIndex` and `FugaSlots_getBySymbol`, these don't look
+*** for the slot's doc, so they cost the same with docs as without.
+**/
+void* FugaSlots_valueByIndex(FugaSlots* self, FugaIndex index) {
+    ALWAYS(self);
+    bool inArray;
+    size_t position;
+    if (!FugaSlots_locate(self, index, &inArray, &position))
+        return NULL;
+    return inArray ? self->array[position] : self->entries[position].value;
+}
+
+void* FugaSlots_valueBySymbol(FugaSlots* self, void* symbol) {
+    ALWAYS(self);
+    ALWAYS(symbol);
+    long position = FugaSlots_find(self, symbol);
+    return position >= 0 ? self->entries[position].value : NULL;
+}
+
+/**
+*** ## Capacity
+*** ### FugaSlots_reserve
+***
+*** Make room for `unnamed` more unnamed slots and `named` more named
+*** slots, so that adding them doesn't have to grow anything. The room is
+*** exactly what was asked for. If that many names call for a bucket table,
+*** it is built now, sized for all of them.
+**/
+void FugaSlots_reserve(
+    FugaSlots* self,
+    size_t unnamed,
+    size_t named
+) {
+    ALWAYS(self);
+    FugaSlots_own(self);
+    if (unnamed)
+        self->array = FugaSlots_fit(self, self->array,
+                                    self->arrayLength + unnamed,
+                                    sizeof(void*));
+    if (named) {
+        size_t names = self->hashLength + named;
+        self->entries = FugaSlots_fit(self, self->entries, names,
+                                      sizeof(FugaSlotEntry));
+        if (names > FUGA_SLOTS_SCAN &&
+            2 * names > FUGA_SLOTS_CAPACITY(self->buckets))
+            FugaSlots_hashFor(self, names);
     }
-    return NULL;
+    if (self->order)
+        self->order = FugaSlotsBuffer_reserve(self->order,
+                          self->length + unnamed + named + 1,
+                          sizeof(uint32_t));
 }
 
 /**
@@ -119,16 +764,12 @@ void FugaSlots_append_(
 ) {
     ALWAYS(self);
     ALWAYS(slot.value);
-
-    self->length++;
-    if (self->capacity < self->length) {
-        self->capacity *= 2;
-        self->slots = realloc(self->slots, sizeof(FugaSlot)
-                                         * self->capacity);
-        ALWAYS(self->capacity >= self->length);
-    }
-    self->slots[self->length-1] = slot;
-    self->slots[self->length-1].index = self->length-1;
+    FugaSlots_own(self);
+    if (slot.name)
+        FugaSlots_appendNamed(self, slot);
+    else
+        FugaSlots_appendUnnamed(self, slot.value);
+    FugaSlots_putDoc(self, self->length - 1, slot.doc);
 }
 
 #ifdef TESTING
@@ -140,31 +781,88 @@ TESTS(FugaSlots_append_) {
         .value = FUGA_SYMBOL("FOO"),
         .doc = NULL
     };
+#define FUGA_SLOTS_TEST_CAPACITY FUGA_SLOTS_CAPACITY(slots->array)
 
-    TEST(slots->length == 0); TEST(slots->capacity == 4);
+    TEST(slots->length == 0); TEST(FUGA_SLOTS_TEST_CAPACITY == 0);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 1); TEST(slots->capacity == 4);
+    TEST(slots->length == 1); TEST(FUGA_SLOTS_TEST_CAPACITY == 4);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 2); TEST(slots->capacity == 4);
+    TEST(slots->length == 2); TEST(FUGA_SLOTS_TEST_CAPACITY == 4);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 3); TEST(slots->capacity == 4);
+    TEST(slots->length == 3); TEST(FUGA_SLOTS_TEST_CAPACITY == 4);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 4); TEST(slots->capacity == 4);
+    TEST(slots->length == 4); TEST(FUGA_SLOTS_TEST_CAPACITY == 4);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 5); TEST(slots->capacity == 8);
+    TEST(slots->length == 5); TEST(FUGA_SLOTS_TEST_CAPACITY == 8);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 6); TEST(slots->capacity == 8);
+    TEST(slots->length == 6); TEST(FUGA_SLOTS_TEST_CAPACITY == 8);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 7); TEST(slots->capacity == 8);
+    TEST(slots->length == 7); TEST(FUGA_SLOTS_TEST_CAPACITY == 8);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 8); TEST(slots->capacity == 8);
+    TEST(slots->length == 8); TEST(FUGA_SLOTS_TEST_CAPACITY == 8);
     FugaSlots_append_(slots, slot);
-    TEST(slots->length == 9); TEST(slots->capacity == 16);
+    TEST(slots->length == 9); TEST(FUGA_SLOTS_TEST_CAPACITY == 16);
+
+    // A pure list needs neither entries nor an order vector.
+    TEST(slots->entries == NULL);
+    TEST(slots->order == NULL);
+    TEST(slots->docs == NULL);
 
     Fuga_quit(self);
 }
 #endif
 
+/**
+*** ### FugaSlots_extend_
+***
+*** Append the values of all of `other`'s slots to `self`, as unnamed
+*** slots, along with their docs. `self` grows once, up front.
+**/
+void FugaSlots_extend_(
+    FugaSlots* self,
+    FugaSlots* other
+) {
+    ALWAYS(self); ALWAYS(other);
+    size_t length = other->length;
+    FugaSlots_reserve(self, length, 0);
+    for (size_t i = 0; i < length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(other, i);
+        FugaSlots_appendUnnamed(self, slot.value);
+        if (slot.doc)
+            FugaSlots_putDoc(self, self->length - 1, slot.doc);
+    }
+}
+
+/**
+*** ### FugaSlots_rebuild
+***
+*** Replace the slot at `index` by `slot`, the slow way: take all the slots
+*** out, and put them back in. Used when a slot has to move between the
+*** array and the hash part. Indices don't change, so neither do the docs.
+**/
+static void FugaSlots_rebuild(FugaSlots* self, FugaIndex index, FugaSlot slot) {
+    size_t length = self->length;
+    FugaSlot* slots = malloc(length * sizeof(FugaSlot));
+    for (size_t i = 0; i < length; i++)
+        slots[i] = FugaSlots_getByIndex(self, i);
+    slots[index] = slot;
+
+    FugaSlotsBuffer_free(self->array);
+    FugaSlotsBuffer_free(self->entries);
+    FugaSlotsBuffer_free(self->buckets);
+    FugaSlotsBuffer_free(self->order);
+    self->length = self->arrayLength = self->hashLength = 0;
+    self->array   = NULL;
+    self->entries = NULL;
+    self->buckets = self->order = NULL;
+    for (size_t i = 0; i < length; i++) {
+        if (slots[i].name)
+            FugaSlots_appendNamed(self, slots[i]);
+        else
+            FugaSlots_appendUnnamed(self, slots[i].value);
+    }
+    free(slots);
+}
 
 /**
 *** ## Set
@@ -182,11 +880,21 @@ void FugaSlots_setByIndex(
     ALWAYS(index <= self->length);
 
     if (index == self->length) {
-        FugaSlots_append_(self, slot); 
-    } else {
-        self->slots[index] = slot;
-        self->slots[index].index = index;
+        FugaSlots_append_(self, slot);
+        return;
     }
+
+    bool inArray;
+    size_t position;
+    FugaSlots_locate(self, index, &inArray, &position);
+    FugaSlots_own(self);
+    if (inArray && !slot.name)
+        self->array[position] = slot.value;
+    else if (!inArray && slot.name == self->entries[position].name)
+        self->entries[position].value = slot.value;
+    else
+        FugaSlots_rebuild(self, index, slot);
+    FugaSlots_putDoc(self, index, slot.doc);
 }
 
 #ifdef TESTING
@@ -202,22 +910,22 @@ TESTS(FugaSlots_setByIndex) {
 
     TEST(FugaSlots_length(slots) == 0);
     TEST(!FugaSlots_hasByIndex(slots, 0));
-    TEST(FugaSlots_getByIndex(slots, 0) == NULL)
+    TEST(FugaSlots_getByIndex(slots, 0).value == NULL)
     FugaSlots_setByIndex(slots, 0, slot1);
     TEST(h = FugaSlots_hasByIndex(slots, 0));
     if (h) {
-        TEST(FugaSlots_getByIndex(slots, 0)->value == value1)
+        TEST(FugaSlots_getByIndex(slots, 0).value == value1)
     }
     TEST(FugaSlots_length(slots) == 1);
 
     TEST(!FugaSlots_hasByIndex(slots, 1));
-    TEST(FugaSlots_getByIndex(slots, 1) == NULL);
+    TEST(FugaSlots_getByIndex(slots, 1).value == NULL);
     FugaSlots_setByIndex(slots, 1, slot2);
     TEST(h = FugaSlots_hasByIndex(slots, 1));
     if (h) {
-        TEST(FugaSlots_getByIndex(slots, 1)->value == value2)
+        TEST(FugaSlots_getByIndex(slots, 1).value == value2)
         FugaSlots_setByIndex(slots, 1, slot1);
-        TEST(FugaSlots_getByIndex(slots, 1)->value == value1)
+        TEST(FugaSlots_getByIndex(slots, 1).value == value1)
     }
     TEST(FugaSlots_length(slots) == 2);
 
@@ -230,6 +938,22 @@ TESTS(FugaSlots_setByIndex) {
 }
 #endif
 
+/**
+*** Set a named slot, in a FugaSlots that is already owned.
+**/
+static void FugaSlots_put(FugaSlots* self, FugaSlot slot) {
+    long position = FugaSlots_find(self, slot.name);
+    if (position >= 0) {
+        self->entries[position].value = slot.value;
+        if (self->docs || slot.doc)
+            FugaSlots_putDoc(self, FugaSlots_entryIndex(self, position),
+                             slot.doc);
+    } else {
+        FugaSlots_appendNamed(self, slot);
+        FugaSlots_putDoc(self, self->length - 1, slot.doc);
+    }
+}
+
 /**
 *** ### FugaSlots_setBySymbol
 ***
@@ -244,15 +968,9 @@ void FugaSlots_setBySymbol(
     ALWAYS(slot.value);
     ALWAYS(name);
 
-    for (FugaIndex i = 0; i < self->length; i++) {
-        if (self->slots[i].name &&
-            Fuga_is_(self->slots[i].name, name)) {
-            self->slots[i] = slot;
-            self->slots[i].index = i;
-            return;
-        }
-    }
-    FugaSlots_append_(self, slot);
+    FugaSlots_own(self);
+    slot.name = name;
+    FugaSlots_put(self, slot);
 }
 
 #ifdef TESTING
@@ -270,57 +988,143 @@ TESTS(FugaSlots_setBySymbol) {
 
     TEST(FugaSlots_length(slots) == 0);
     TEST(!FugaSlots_hasBySymbol(slots, name1));
-    TEST( FugaSlots_getBySymbol(slots, name1) == NULL)
+    TEST( FugaSlots_getBySymbol(slots, name1).value == NULL)
     FugaSlots_setBySymbol(slots, name1, slot1);
     TEST(h = FugaSlots_hasBySymbol(slots, name1));
     if (h) {
-        TEST(FugaSlots_getBySymbol(slots, name1)->value == value1)
+        TEST(FugaSlots_getBySymbol(slots, name1).value == value1)
     }
 
     TEST(FugaSlots_length(slots) == 1);
     TEST(!FugaSlots_hasBySymbol(slots, name2));
-    TEST( FugaSlots_getBySymbol(slots, name2) == NULL)
+    TEST( FugaSlots_getBySymbol(slots, name2).value == NULL)
     FugaSlots_setBySymbol(slots, name2, slot2);
     TEST(h = FugaSlots_hasBySymbol(slots, name2));
     if (h) {
         TEST(FugaSlots_length(slots) == 2);
-        TEST(FugaSlots_getBySymbol(slots, name2)->value == value2)
+        TEST(FugaSlots_getBySymbol(slots, name2).value == value2)
         slot2.value = value1;
         FugaSlots_setBySymbol(slots, name2, slot2);
-        TEST(FugaSlots_getBySymbol(slots, name2)->value == value1);
+        TEST(FugaSlots_getBySymbol(slots, name2).value == value1);
         TEST(FugaSlots_length(slots) == 2);
     }
 
     TEST(h = FugaSlots_hasByIndex(slots, 0));
     if (h) {
-        TEST(FugaSlots_getByIndex(slots, 0)->value == value1);
+        TEST(FugaSlots_getByIndex(slots, 0).value == value1);
     }
     TEST(h = FugaSlots_hasByIndex(slots, 1));
     if (h) {
-        TEST(FugaSlots_getByIndex(slots, 1)->value == value1);
-    }   
+        TEST(FugaSlots_getByIndex(slots, 1).value == value1);
+    }
 
     Fuga_quit(self);
 }
 #endif
 
+/**
+*** ### FugaSlots_update_
+***
+*** Set all of `other`'s named slots in `self`, along with their docs.
+*** Room for all of them is made up front, so a large update builds its
+*** bucket table once; it is dropped again afterwards if `self` turns out
+*** small enough to scan.
+**/
+void FugaSlots_update_(
+    FugaSlots* self,
+    FugaSlots* other
+) {
+    ALWAYS(self); ALWAYS(other);
+    if (self == other || !other->hashLength)
+        return;
+    FugaSlots_reserve(self, 0, other->hashLength);
+    for (size_t i = 0; i < other->length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(other, i);
+        if (slot.name)
+            FugaSlots_put(self, slot);
+    }
+    if (self->buckets && self->hashLength <= FUGA_SLOTS_SCAN)
+        FugaSlots_rehash(self);
+}
+
+/**
+*** ### FugaSlots_setDocByIndex
+***
+*** Set the documentation of the slot with the given index.
+**/
+void FugaSlots_setDocByIndex(
+    FugaSlots* self,
+    FugaIndex index,
+    void* doc
+) {
+    ALWAYS(self);
+    if (index >= self->length)
+        return;
+    FugaSlots_own(self);
+    FugaSlots_putDoc(self, index, doc);
+}
+
+/**
+*** ### FugaSlots_setDocBySymbol
+***
+*** Set the documentation of the slot with the given name.
+**/
+void FugaSlots_setDocBySymbol(
+    FugaSlots* self,
+    void* name,
+    void* doc
+) {
+    ALWAYS(self); ALWAYS(name);
+    long position = FugaSlots_find(self, name);
+    if (position >= 0) {
+        FugaSlots_own(self);
+        FugaSlots_putDoc(self, FugaSlots_entryIndex(self, position), doc);
+    }
+}
 
 void FugaSlots_delByIndex(
     FugaSlots* self,
     FugaIndex index
 ) {
     ALWAYS(self);
-    /* GCC WARNS Tautological compare:
-     *   if ((index >= 0) && (index < self->length)) {
-     * TODO remove comment.
-     */
-    if ((index < self->length)) {
-        for(FugaIndex i = index+1; i < self->length; i++) {
-            self->slots[i-1] = self->slots[i];
-            self->slots[i-1].index = i-1;
+    bool inArray;
+    size_t position;
+    if (!FugaSlots_locate(self, index, &inArray, &position))
+        return;
+    FugaSlots_own(self);
+
+    if (inArray) {
+        size_t after = self->arrayLength - position - 1;
+        memmove(self->array + position, self->array + position + 1,
+                after * sizeof(void*));
+        self->arrayLength--;
+    } else {
+        size_t after = self->hashLength - position - 1;
+        memmove(self->entries + position, self->entries + position + 1,
+                after * sizeof(FugaSlotEntry));
+        self->hashLength--;
+        if (self->buckets)
+            FugaSlots_rehash(self);
+    }
+
+    if (self->docs) {
+        FugaSlots_putDoc(self, index, NULL);
+        for (size_t i = 0; i < self->docsLength; i++)
+            if (self->docs[i].index > index)
+                self->docs[i].index--;
+    }
+
+    if (self->order) {
+        uint32_t part = inArray ? FUGA_SLOTS_ARRAY : 0;
+        memmove(self->order + index, self->order + index + 1,
+                (self->length - index - 1) * sizeof(uint32_t));
+        for (size_t i = 0; i < self->length - 1; i++) {
+            if ((self->order[i] & FUGA_SLOTS_ARRAY) == part &&
+                (self->order[i] & ~FUGA_SLOTS_ARRAY) > position)
+                self->order[i]--;
         }
-        self->length--;
     }
+    self->length--;
 }
 
 void FugaSlots_delBySymbol(
@@ -328,9 +1132,260 @@ void FugaSlots_delBySymbol(
     void* symbol
 ) {
     ALWAYS(self); ALWAYS(symbol);
-    FugaSlot* slot = FugaSlots_getBySymbol(self, symbol);
-    if (slot) {
-        FugaSlots_delByIndex(self, slot->index);
+    long position = FugaSlots_find(self, symbol);
+    if (position >= 0)
+        FugaSlots_delByIndex(self, FugaSlots_entryIndex(self, position));
+}
+
+#ifdef TESTING
+TESTS(FugaSlots_interleaved) {
+    void* self = Fuga_init();
+    void* a = FUGA_SYMBOL("a");
+    void* b = FUGA_SYMBOL("b");
+    void* x = FUGA_INT(1);
+    void* y = FUGA_INT(2);
+    FugaSlot named = {.name = a, .value = x, .doc = NULL};
+    FugaSlot unnamed = {.name = NULL, .value = y, .doc = NULL};
+
+    // (a = 1, 2): names come first, no order vector needed.
+    FugaSlots* slots = FugaSlots_new(self);
+    FugaSlots_append_(slots, named);
+    FugaSlots_append_(slots, unnamed);
+    TEST(slots->order == NULL);
+    TEST(FugaSlots_getByIndex(slots, 0).name == a);
+    TEST(FugaSlots_getByIndex(slots, 1).value == y);
+
+    // (a = 1, 2, b = 1, 2)
+    named.name = b;
+    FugaSlots_append_(slots, named);
+    FugaSlots_append_(slots, unnamed);
+    TEST(slots->order != NULL);
+    TEST(FugaSlots_length(slots) == 4);
+    TEST(FugaSlots_getByIndex(slots, 0).name == a);
+    TEST(FugaSlots_getByIndex(slots, 1).name == NULL);
+    TEST(FugaSlots_getByIndex(slots, 2).name == b);
+    TEST(FugaSlots_getByIndex(slots, 3).value == y);
+    TEST(FugaSlots_getBySymbol(slots, b).value == x);
+
+    // (2, b = 1, 2)
+    FugaSlots_delBySymbol(slots, a);
+    TEST(FugaSlots_length(slots) == 3);
+    TEST(FugaSlots_getByIndex(slots, 0).name == NULL);
+    TEST(FugaSlots_getByIndex(slots, 1).name == b);
+    TEST(FugaSlots_getByIndex(slots, 2).name == NULL);
+
+    // (2, 2, 2)
+    FugaSlots_setByIndex(slots, 1, unnamed);
+    TEST(FugaSlots_length(slots) == 3);
+    TEST(!FugaSlots_hasBySymbol(slots, b));
+    TEST(FugaSlots_getByIndex(slots, 1).value == y);
+
+    // (2, 2)
+    FugaSlots_delByIndex(slots, 0);
+    TEST(FugaSlots_length(slots) == 2);
+    TEST(FugaSlots_getByIndex(slots, 1).value == y);
+
+    // lots of names
+    slots = FugaSlots_new(self);
+    char name[16];
+    for (int i = 0; i < 100; i++) {
+        sprintf(name, "n%d", i);
+        named.name = FUGA_SYMBOL(name);
+        named.value = FUGA_INT(i);
+        FugaSlots_append_(slots, named);
+        FugaSlots_append_(slots, unnamed);
     }
+    TEST(slots->buckets != NULL);
+    TEST(FugaSlots_length(slots) == 200);
+    TEST(FugaInt_is_(FugaSlots_getBySymbol(slots, FUGA_SYMBOL("n57")).value,
+                     57));
+    TEST(FugaSlots_getByIndex(slots, 114).name == FUGA_SYMBOL("n57"));
+    FugaSlots_delBySymbol(slots, FUGA_SYMBOL("n3"));
+    TEST(!FugaSlots_hasBySymbol(slots, FUGA_SYMBOL("n3")));
+    TEST(FugaSlots_getByIndex(slots, 113).name == FUGA_SYMBOL("n57"));
+    TEST(FugaInt_is_(FugaSlots_getBySymbol(slots, FUGA_SYMBOL("n99")).value,
+                     99));
+
+    Fuga_quit(self);
 }
 
+TESTS(FugaSlots_copy) {
+    void* self = Fuga_init();
+    void* value1 = Fuga_clone(FUGA->Object);
+    void* value2 = Fuga_clone(FUGA->Object);
+    void* name   = FUGA_SYMBOL("hello");
+    FugaSlot slot1 = {.name = name, .value = value1, .doc = NULL};
+    FugaSlot slot2 = {.name = NULL, .value = value2, .doc = NULL};
+
+    FugaSlots* slots = FugaSlots_new(self);
+    FugaSlots_append_(slots, slot1);
+    FugaSlots* copy  = FugaSlots_copy(slots);
+    TEST(copy->entries == slots->entries);
+    TEST(FUGA_SLOTS_BUFFER(slots->entries)->refs == 2);
+    TEST(FugaSlots_length(copy) == 1);
+    TEST(FugaSlots_getBySymbol(copy, name).value == value1);
+
+    FugaSlots_append_(copy, slot2);
+    TEST(copy->entries != slots->entries);
+    TEST(FUGA_SLOTS_BUFFER(slots->entries)->refs == 1);
+    TEST(FUGA_SLOTS_BUFFER(copy->entries)->refs == 1);
+    TEST(FugaSlots_length(slots) == 1);
+    TEST(FugaSlots_length(copy)  == 2);
+
+    copy = FugaSlots_copy(slots);
+    slot1.value = value2;
+    FugaSlots_setBySymbol(slots, name, slot1);
+    TEST(FugaSlots_getBySymbol(slots, name).value == value2);
+    TEST(FugaSlots_getBySymbol(copy,  name).value == value1);
+
+    copy = FugaSlots_copy(slots);
+    FugaSlots_setDocByIndex(copy, 0, value1);
+    TEST(FugaSlots_getByIndex(copy,  0).doc == value1);
+    TEST(FugaSlots_getByIndex(slots, 0).doc == NULL);
+
+    copy = FugaSlots_copy(slots);
+    FugaSlots_delByIndex(copy, 0);
+    TEST(FugaSlots_length(copy)  == 0);
+    TEST(FugaSlots_length(slots) == 1);
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaSlots_embed) {
+    void* self = Fuga_init();
+    void* name1 = FUGA_SYMBOL("a");
+    void* name2 = FUGA_SYMBOL("b");
+    FugaSlot named   = {.name = name1, .value = name1, .doc = NULL};
+    FugaSlot unnamed = {.name = NULL,  .value = name2, .doc = NULL};
+
+    // A msg with a couple of arguments stays within its own allocation.
+    void* msg = FUGA_MSG("foo");
+    FugaSlots* slots = FUGA_HEADER(msg)->slots;
+    TEST(slots && slots->small);
+    for (int i = 0; i < FUGA_SLOTS_SMALL; i++)
+        FugaSlots_append_(slots, unnamed);
+    TEST(slots->array == slots->small);
+    FugaSlots_append_(slots, unnamed);
+    TEST(slots->array != slots->small);
+    TEST(FugaSlots_length(slots) == FUGA_SLOTS_SMALL + 1);
+    TEST(FugaSlots_getByIndex(slots, FUGA_SLOTS_SMALL).value == name2);
+
+    // Once the array part leaves, the hash part can have the small buffer.
+    FugaSlots_append_(slots, named);
+    TEST(slots->entries == slots->small);
+    TEST(FugaSlots_getBySymbol(slots, name1).value == name1);
+
+    // Copies never share the small buffer.
+    void* object = Fuga_clone(FUGA->Object);
+    slots = FUGA_HEADER(object)->slots;
+    FugaSlots_append_(slots, named);
+    FugaSlots* copy = FugaSlots_copy(slots);
+    TEST(slots->entries == slots->small);
+    TEST(copy->entries && copy->entries != slots->entries);
+    TEST(FugaSlots_getBySymbol(copy, name1).value == name1);
+    FugaSlots_share_(FUGA_HEADER(msg)->slots, slots);
+    TEST(FUGA_HEADER(msg)->slots->entries == FUGA_HEADER(msg)->slots->small);
+    TEST(FugaSlots_length(FUGA_HEADER(msg)->slots) == 1);
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaSlots_bulk) {
+    void* self = Fuga_init();
+    void* doc = FUGA_STRING("doc");
+    char name[16];
+
+    FugaSlots* slots = FugaSlots_new(self);
+    FugaSlots_reserve(slots, 1000, 0);
+    TEST(FUGA_SLOTS_CAPACITY(slots->array) == 1000);
+    void* array = slots->array;
+    FugaSlot slot = {.name = NULL, .value = doc, .doc = NULL};
+    for (int i = 0; i < 1000; i++)
+        FugaSlots_append_(slots, slot);
+    TEST(slots->array == array);
+
+    // (a0 = 0, ..., a19 = 19) update (a10 = 0, ..., a29 = 0, 1)
+    FugaSlots* other = FugaSlots_new(self);
+    slots = FugaSlots_new(self);
+    for (int i = 0; i < 30; i++) {
+        sprintf(name, "a%d", i);
+        FugaSlot named = {.name = FUGA_SYMBOL(name), .doc = NULL};
+        named.value = FUGA_INT(i);
+        if (i < 20)
+            FugaSlots_append_(slots, named);
+        named.value = FUGA_INT(0);
+        if (i >= 10)
+            FugaSlots_append_(other, named);
+    }
+    FugaSlots_append_(other, slot);
+    FugaSlots_setDocBySymbol(other, FUGA_SYMBOL("a25"), doc);
+    FugaSlots_update_(slots, other);
+    TEST(FugaSlots_length(slots) == 30);
+    TEST(FUGA_SLOTS_CAPACITY(slots->entries) == 40);
+    TEST(FugaInt_is_(FugaSlots_getBySymbol(slots, FUGA_SYMBOL("a5")).value, 5));
+    TEST(FugaInt_is_(FugaSlots_getBySymbol(slots, FUGA_SYMBOL("a15")).value, 0));
+    TEST(FugaSlots_getBySymbol(slots, FUGA_SYMBOL("a25")).doc == doc);
+    TEST(FugaSlots_getByIndex(slots, 25).doc == doc);
+
+    // A small update leaves no bucket table behind.
+    FugaSlots* small = FugaSlots_new(self);
+    FugaSlots* update = FugaSlots_new(self);
+    FugaSlot named = {.name = FUGA_SYMBOL("a1"), .value = doc, .doc = NULL};
+    FugaSlots_append_(update, named);
+    FugaSlots_update_(small, update);
+    TEST(small->buckets == NULL);
+    TEST(FugaSlots_getBySymbol(small, FUGA_SYMBOL("a1")).value == doc);
+
+    // extend appends values, not names.
+    FugaSlots_extend_(small, other);
+    TEST(FugaSlots_length(small) == 22);
+    TEST(FugaSlots_getByIndex(small, 1).name == NULL);
+    TEST(FugaInt_is_(FugaSlots_getByIndex(small, 1).value, 0));
+    TEST(FugaSlots_getByIndex(small, 16).doc == doc);
+    TEST(FugaSlots_getByIndex(small, 21).value == doc);
+    FugaSlots_extend_(small, small);
+    TEST(FugaSlots_length(small) == 44);
+    TEST(FugaSlots_getByIndex(small, 38).doc == doc);
+
+    Fuga_quit(self);
+}
+
+TESTS(FugaSlots_docs) {
+    void* self = Fuga_init();
+    void* name  = FUGA_SYMBOL("hello");
+    void* doc   = FUGA_STRING("doc");
+    FugaSlot slot1 = {.name = NULL, .value = name, .doc = NULL};
+    FugaSlot slot2 = {.name = name, .value = name, .doc = NULL};
+
+    FugaSlots* slots = FugaSlots_new(self);
+    FugaSlots_append_(slots, slot1);
+    FugaSlots_append_(slots, slot1);
+    FugaSlots_append_(slots, slot2);
+    TEST(!FugaSlots_hasDocs(slots));
+
+    FugaSlots_setDocByIndex(slots, 1, doc);
+    FugaSlots_setDocBySymbol(slots, name, doc);
+    TEST(FugaSlots_hasDocs(slots));
+    TEST(FugaSlots_getByIndex(slots, 0).doc == NULL);
+    TEST(FugaSlots_getByIndex(slots, 1).doc == doc);
+    TEST(FugaSlots_getByIndex(slots, 2).doc == doc);
+    TEST(FugaSlots_getBySymbol(slots, name).doc == doc);
+    TEST(FugaSlots_valueByIndex(slots, 1) == name);
+    TEST(FugaSlots_valueByIndex(slots, 3) == NULL);
+    TEST(FugaSlots_valueBySymbol(slots, name) == name);
+    TEST(FugaSlots_valueBySymbol(slots, doc) == NULL);
+
+    FugaSlots_delByIndex(slots, 0);
+    TEST(FugaSlots_getByIndex(slots, 0).doc == doc);
+    TEST(FugaSlots_getByIndex(slots, 1).doc == doc);
+
+    // Setting a slot replaces its doc, too.
+    FugaSlots_setBySymbol(slots, name, slot2);
+    TEST(FugaSlots_getBySymbol(slots, name).doc == NULL);
+    FugaSlots_setDocByIndex(slots, 0, NULL);
+    TEST(!FugaSlots_hasDocs(slots));
+
+    Fuga_quit(self);
+}
+#endif
+
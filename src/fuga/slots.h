@@ -26,14 +26,16 @@ typedef struct FugaSlots FugaSlots;
 /**
 *** ### FugaSlot
 ***
-*** Represents an individual slot. That is, a (name, value) pair.
+*** Represents an individual slot. That is, a (name, value) pair, plus the
+*** slot's documentation. This is how slots are passed in and out of
+*** FugaSlots; it is not how they are stored. A `FugaSlot` with a NULL
+*** `value` means "no such slot".
 **/
 typedef struct FugaSlot FugaSlot;
 struct FugaSlot {
     void* value;
     void* name;
     void* doc;
-    FugaIndex index;
 };
 
 /**
@@ -44,6 +46,35 @@ struct FugaSlot {
 **/
 FugaSlots* FugaSlots_new(void* gc);
 
+/**
+*** ### FugaSlots_copy
+***
+*** Create a FugaSlots with the same slots as `slots`, in O(1). The copy
+*** shares storage with the original until either of them is written to,
+*** at which point the writer gets its own copy of the storage.
+**/
+FugaSlots* FugaSlots_copy(FugaSlots* slots);
+
+/**
+*** ### FugaSlots_share_
+***
+*** Replace the slots of `slots` by those of `other`, in O(1), sharing
+*** storage the same way `FugaSlots_copy` does.
+**/
+void FugaSlots_share_(FugaSlots* slots, FugaSlots* other);
+
+/**
+*** ### FugaSlots_embed
+***
+*** Plain objects keep their FugaSlots, along with storage for their first
+*** few slots, in their own allocation: `FugaSlots_embedSize` bytes right
+*** in front of their header. `FugaSlots_embed` sets up such a FugaSlots
+*** in `block` on behalf of `owner`. Only objects that would have slots
+*** anyway should pay for this; see `Fuga_cloneInline_`.
+**/
+extern const size_t FugaSlots_embedSize;
+FugaSlots* FugaSlots_embed(void* owner, void* block);
+
 /**
 *** ## Properties
 *** ### FugaSlots_length
@@ -53,6 +84,50 @@ FugaSlots* FugaSlots_new(void* gc);
 **/
 size_t FugaSlots_length(FugaSlots* slots);
 
+/**
+*** ### FugaSlots_hasDocs
+***
+*** Determine whether any slot has documentation. This is a single pointer
+*** test, so it's a cheap way to skip looking for docs altogether.
+**/
+bool FugaSlots_hasDocs(FugaSlots* slots);
+
+/**
+*** ## Compiled Code
+*** ### FugaSlots_code
+***
+*** Return the compiled code kept with the slots by `FugaSlots_code_`, or
+*** NULL if there is none. Copies share compiled code, and every write
+*** drops it, so it is never out of date.
+**/
+void* FugaSlots_code(FugaSlots* slots);
+
+/**
+*** ### FugaSlots_code_
+***
+*** Keep `count` zeroed elements of `size` bytes with the slots, as their
+*** compiled code, and return them to be filled in.
+**/
+void* FugaSlots_code_(FugaSlots* slots, size_t count, size_t size);
+
+/**
+*** ### FugaSlots_retainCode
+*** ### FugaSlots_releaseCode
+***
+*** Hold on to compiled code while running it, in case its slots are
+*** written to (and drop it) meanwhile.
+**/
+void* FugaSlots_retainCode(void* code);
+void  FugaSlots_releaseCode(void* code);
+
+/**
+*** ### FugaSlots_writes
+***
+*** Return how many times the slots have been written to. Anything worked
+*** out from the slots stays valid for as long as this doesn't change.
+**/
+size_t FugaSlots_writes(FugaSlots* slots);
+
 /**
 *** ## Has
 *** ### FugaSlots_hasByIndex
@@ -72,24 +147,60 @@ bool FugaSlots_hasBySymbol(FugaSlots* slots, void* symbol);
 *** ## Get
 *** ### FugaSlots_getByIndex
 ***
-*** Get the slot associated with a given index.
+*** Get the slot associated with a given index. The result's `value` is
+*** NULL if there is no such slot.
 **/
-FugaSlot* FugaSlots_getByIndex(FugaSlots* slots, FugaIndex index);
+FugaSlot FugaSlots_getByIndex(FugaSlots* slots, FugaIndex index);
 
 /**
 *** ### FugaSlots_getBySymbol
 ***
-*** Get the slot associated with a given symbol.
+*** Get the slot associated with a given symbol. The result's `value` is
+*** NULL if there is no such slot.
+**/
+FugaSlot FugaSlots_getBySymbol(FugaSlots* slots, void* name);
+
+/**
+*** ### FugaSlots_valueByIndex
+*** ### FugaSlots_valueBySymbol
+***
+*** Get just the value of a slot, or NULL if there is no such slot. These
+*** don't look up docs, so use them where only the value is wanted.
+**/
+void* FugaSlots_valueByIndex(FugaSlots* slots, FugaIndex index);
+void* FugaSlots_valueBySymbol(FugaSlots* slots, void* name);
+
+/**
+*** ## Capacity
+*** ### FugaSlots_reserve
+***
+*** Make room for `unnamed` more unnamed slots and `named` more named
+*** slots, so adding them one by one never has to grow the storage.
 **/
-FugaSlot* FugaSlots_getBySymbol(FugaSlots* slots, void* name);
+void FugaSlots_reserve(FugaSlots* slots, size_t unnamed, size_t named);
 
+/**
+*** ## Append
+*** ### FugaSlots_append_
+***
+*** Add a slot to the end.
+**/
 void FugaSlots_append_(FugaSlots* slots, FugaSlot value);
 
+/**
+*** ### FugaSlots_extend_
+***
+*** Add the values of all of `other`'s slots to the end, unnamed, with
+*** their docs. Sizes `slots` once.
+**/
+void FugaSlots_extend_(FugaSlots* slots, FugaSlots* other);
+
 /**
 *** ## Set
 *** ### FugaSlots_setByIndex
 ***
-*** Set or update the slot associated with a given index.
+*** Set or update the slot associated with a given index. The slot keeps
+*** its position, and takes `slot`'s name (usually none).
 **/
 void FugaSlots_setByIndex(FugaSlots* slots, FugaIndex index, FugaSlot slot);
 
@@ -100,6 +211,34 @@ void FugaSlots_setByIndex(FugaSlots* slots, FugaIndex index, FugaSlot slot);
 **/
 void FugaSlots_setBySymbol(FugaSlots* slots, void* name, FugaSlot slot);
 
+/**
+*** ### FugaSlots_update_
+***
+*** Set all of `other`'s named slots, with their docs. Sizes `slots` once.
+**/
+void FugaSlots_update_(FugaSlots* slots, FugaSlots* other);
+
+/**
+*** ### FugaSlots_setDocByIndex
+***
+*** Set the documentation of the slot associated with a given index.
+**/
+void FugaSlots_setDocByIndex(FugaSlots* slots, FugaIndex index, void* doc);
+
+/**
+*** ### FugaSlots_setDocBySymbol
+***
+*** Set the documentation of the slot associated with a given symbol.
+**/
+void FugaSlots_setDocBySymbol(FugaSlots* slots, void* name, void* doc);
+
+/**
+*** ## Delete
+*** ### FugaSlots_delByIndex
+*** ### FugaSlots_delBySymbol
+***
+*** Remove a slot. Later slots move down one index.
+**/
 void FugaSlots_delByIndex  (FugaSlots* slots, FugaIndex index);
 void FugaSlots_delBySymbol (FugaSlots* slots, void* name);
 
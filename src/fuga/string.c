@@ -43,7 +43,75 @@ FugaString* FugaString_new(void* self, const char* value)
     return result;
 }
 
+/**
+ * Strings for constant C strings (like the messages of FUGA_RAISE) are
+ * made once and shared, in a small cache keyed on the address of the C
+ * string. A hit is checked against the contents, so C strings that
+ * aren't constant only miss. They're frozen (see Fuga_freeze), since
+ * every exception raised with the same message shares one.
+ */
+#define FUGA_STRING_CONSTS 256
+
+typedef struct {
+    const char* keys  [FUGA_STRING_CONSTS];
+    FugaString* values[FUGA_STRING_CONSTS];
+} FugaStringConsts;
+
+const FugaType FugaStringConsts_type = {
+    .name = "C FugaStringConsts"
+};
+
+void FugaStringConsts_mark(void* _self)
+{
+    FugaStringConsts* self = _self;
+    for (size_t i = 0; i < FUGA_STRING_CONSTS; i++)
+        Fuga_mark_(self, self->values[i]);
+}
+
+void* FugaString_consts(void* self)
+{
+    ALWAYS(self);
+    FugaStringConsts* result = Fuga_clone_(FUGA->Object, sizeof *result);
+    Fuga_type_(result, &FugaStringConsts_type);
+    Fuga_onMark_(result, FugaStringConsts_mark);
+    return result;
+}
+
+FugaString* FugaString_const(void* self, const char* value)
+{
+    ALWAYS(self); ALWAYS(value);
+    FugaStringConsts* consts = FUGA->strings;
+    if (!consts)
+        return FUGA_STRING(value);
+    size_t i = ((uintptr_t)value >> 3) % FUGA_STRING_CONSTS;
+    FugaString* result = consts->values[i];
+    if (consts->keys[i] != value || !result || strcmp(result->data, value)) {
+        result = FUGA_STRING(value);
+        Fuga_freeze(result);
+        consts->keys[i]   = value;
+        consts->values[i] = result;
+    }
+    return result;
+}
+
 #ifdef TESTING
+TESTS(FugaString_const) {
+    void* self = Fuga_init();
+    const char* hello = "hello";
+    char buffer[8] = "abc";
+    FugaString* a = FugaString_const(self, hello);
+    TEST(FugaString_is_(a, "hello"));
+    TEST(FugaString_const(self, hello) == a);
+    TEST(Fuga_isFrozen(a));
+    TEST(Fuga_isRaised(Fuga_setS(a, "tag", FUGA_INT(1))));
+    TEST(Fuga_isFalse(Fuga_hasS(FugaString_const(self, hello), "tag")));
+    FugaString* b = FugaString_const(self, buffer);
+    TEST(FugaString_is_(b, "abc"));
+    buffer[0] = 'x';
+    TEST(FugaString_is_(FugaString_const(self, buffer), "xbc"));
+    Fuga_quit(self);
+}
+
 TESTS(FUGA_STRING) {
     FugaString* self = Fuga_init();
     TEST(Fuga_isString(FUGA_STRING("")));
@@ -88,6 +156,17 @@ bool FugaString_is_(FugaString* self, const char* str)
     return Fuga_isString(self) && (strcmp(self->data, str) == 0);
 }
 
+/**
+ * Hash `size` bytes of string data (FNV-1a), for tables keyed on the
+ * contents of strings.
+ */
+size_t FugaString_hash(const char* data, size_t size)
+{
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    return hash;
+}
 
 void* FugaString_str(void* _self)
 {
@@ -126,11 +205,11 @@ void* FugaString_match_(FugaString* self, FugaString* other)
     FUGA_NEED(self);
     FUGA_NEED(other);
     if (!Fuga_isString(self) || !Fuga_isString(other))
-        FUGA_RAISE(FUGA->MatchError, "String match: matches only on strs");
+        FUGA_NO_MATCH;
     if ((self->length != other->length) || (self->size != other->size))
-        FUGA_RAISE(FUGA->MatchError, "String match: lengths don't match");
+        FUGA_NO_MATCH;
     if (memcmp(self->data, other->data, self->size))
-        FUGA_RAISE(FUGA->MatchError, "String match: no match");
+        FUGA_NO_MATCH;
     return Fuga_clone(FUGA->Object);
 }
 
@@ -371,6 +450,20 @@ FugaString* FugaString_at_(
 ***     ("", "foo")
 ***     
 **/
+/**
+*** Does a string contain the character at `chr`?
+**/
+static bool FugaString_hasChar_(
+    FugaString* self,
+    const char* chr
+) {
+    size_t size = FugaChar_size(chr);
+    for (const char* c = self->data; *c; c += FugaChar_size(c))
+        if (FugaChar_size(c) == size && !memcmp(c, chr, size))
+            return true;
+    return false;
+}
+
 void* FugaString_split_(
     FugaString* self,
     FugaString* splitter
@@ -389,24 +482,29 @@ void* FugaString_split_(
             "String split: expected primitive strings"
         );
 
+    // Count the fragments first, so results only has to grow once.
     void* results = Fuga_clone(FUGA->Object);
-    size_t start  = 0;
-    FugaString* frag;
-    for (size_t i = 0; i < self->length; i++) {
-        FugaString* chr = FugaString_at_(self, FUGA_INT(i));
-        FUGA_CHECK(chr);
-        if (Fuga_isTrue(FugaString_in_(chr, splitter))) {
-            frag = FugaString_from_to_(self, start, i);
-            FUGA_CHECK(frag);
-            start = i+1;
-            if (!ws || !FugaString_is_(frag, ""))
-                FUGA_CHECK(Fuga_append_(results, frag));
+    size_t count  = 1;
+    const char* c;
+    for (c = self->data; *c; c += FugaChar_size(c))
+        count += FugaString_hasChar_(splitter, c);
+    FugaSlots_reserve(FUGA_HEADER(results)->slots, count, 0);
+
+    const char* start = self->data;
+    for (c = start; ; c += FugaChar_size(c)) {
+        if (*c && !FugaString_hasChar_(splitter, c))
+            continue;
+        size_t size = c - start;
+        if (!ws || size) {
+            char buffer[size+1];
+            memcpy(buffer, start, size);
+            buffer[size] = 0;
+            FUGA_CHECK(Fuga_append_(results, FUGA_STRING(buffer)));
         }
+        if (!*c)
+            break;
+        start = c + FugaChar_size(c);
     }
-    frag = FugaString_from_(self, start);
-    FUGA_CHECK(frag);
-    if (!ws || !FugaString_is_(frag, ""))
-        FUGA_CHECK(Fuga_append_(results, frag));
     return results;
 }
 
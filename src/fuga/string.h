@@ -12,9 +12,12 @@ struct FugaString {
 #define FUGA_STRING(x) FugaString_new(self, (x))
 void        FugaString_init     (void*);
 FugaString* FugaString_new      (void*, const char*);
+FugaString* FugaString_const    (void*, const char*);
+void*       FugaString_consts   (void*);
 FugaSymbol* FugaString_toSymbol (FugaString*);
 void        FugaString_print    (FugaString*);
 bool        FugaString_is_      (FugaString* self, const char* str);
+size_t      FugaString_hash     (const char* data, size_t size);
 void*       FugaString_str      (void*);
 void*       FugaString_match_   (FugaString* self, FugaString* other);
 FugaString* FugaString_from_    (FugaString*, long start);
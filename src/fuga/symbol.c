@@ -93,9 +93,9 @@ void* FugaSymbol_match_(FugaSymbol* self, FugaSymbol* other)
     FUGA_NEED(self);
     FUGA_NEED(other);
     if (!Fuga_isSymbol(self) || !Fuga_isSymbol(other))
-        FUGA_RAISE(FUGA->MatchError, "Symbol match: matches only on syms");
+        FUGA_NO_MATCH;
     if (!Fuga_is_(self, other))
-        FUGA_RAISE(FUGA->MatchError, "Symbol match: values don't match");
+        FUGA_NO_MATCH;
     return Fuga_clone(FUGA->Object);
 }
 
@@ -31,9 +31,9 @@ FugaToken* FugaToken_new(
 FugaInt* FugaToken_int(
     FugaToken* self
 ) {
-    ALWAYS(self); ALWAYS(self->value);
+    ALWAYS(self);
     ALWAYS(self->type == FUGA_TOKEN_INT);
-    return FUGA_INT(*(long*)self->value);
+    return FUGA_INT(self->number);
 }
 
 FugaString* FugaToken_string(
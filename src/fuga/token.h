@@ -35,7 +35,8 @@ struct FugaToken {
     char* filename;
     size_t line;
     size_t column;
-    void* value;
+    void* value;        // the text of the token, unless it's an int
+    long number;        // the value of an int token
 };
 
 /**
@@ -0,0 +1,695 @@
+#include "fuga/fuga.h"
+#include "fuga/method.h"
+#include "fuga/parser.h"
+
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * fugac -- compile a Fuga module to C.
+ *
+ * The C file rebuilds the module's code, object for object, the way the
+ * parser would have, and runs it. The body of every method the module
+ * defines with `def` (or `method`) is also compiled to a C function,
+ * which replaces it in the rebuilt code (see FugaCode_compiled_). In a
+ * compiled body, each msg resolves its name with FugaMsg_resolve, and
+ * then, depending on what that gives:
+ *
+ *  - a plain value is the value of the msg,
+ *  - `if` and `do` are compiled inline,
+ *  - an operator gets its operands evaluated by compiled code, and skips
+ *    the send for ints (see FugaMethodOp_fuse),
+ *  - a strict method gets its args evaluated by compiled code,
+ *  - anything else (lazy args, other control forms, methods defined in
+ *    Fuga) gets the msg applied as the interpreter would apply it.
+ *
+ * Since names are only resolved at run time, compiled code does what the
+ * interpreter does even when `if` or `+` mean something else. Code that
+ * isn't a method body (the top level of the module, mostly) runs in the
+ * interpreter.
+ */
+
+typedef struct {
+    void* self;
+
+    // Every object in the module has a slot in `O`, in the order they're
+    // built. `table` maps objects to their slots.
+    void** objects;
+    size_t length;
+    size_t capacity;
+    long*  table;
+    size_t tableSize;
+
+    // The code compiled to functions, as slots in `O`: the method bodies
+    // first, then the args they evaluate.
+    long*  queue;
+    size_t queueLength;
+    size_t queueCapacity;
+    bool*  queued;
+
+    FILE*  out;
+    FILE*  build;
+    FILE*  functions;
+    int    indent;
+    long   vars;
+    const char* error;
+} FugaC;
+
+typedef struct {
+    char recv[24];
+    char scope[24];
+    const char* tail;
+} FugaCEnv;
+
+static void FugaC_line(FugaC* c, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    fprintf(c->out, "%*s", 4 * c->indent, "");
+    vfprintf(c->out, format, args);
+    fputc('\n', c->out);
+    va_end(args);
+}
+
+static void FugaC_string(FILE* out, const char* data, size_t size)
+{
+    fputc('"', out);
+    for (size_t i = 0; i < size; i++) {
+        unsigned char ch = data[i];
+        if (ch == '"' || ch == '\\' || ch == '?')
+            fprintf(out, "\\%c", ch);
+        else if (ch == '\n')
+            fputs("\\n", out);
+        else if (ch == '\t')
+            fputs("\\t", out);
+        else if (ch < 32 || ch > 126)
+            fprintf(out, "\\%03o", ch);
+        else
+            fputc(ch, out);
+    }
+    fputc('"', out);
+}
+
+/**
+ * The table from objects to their slots in `O`: open addressing, on the
+ * object's address.
+ */
+static size_t FugaC_hash(FugaC* c, void* object)
+{
+    size_t hash = (size_t)object >> 4;
+    size_t i = hash & (c->tableSize - 1);
+    while (c->table[i] >= 0 && c->objects[c->table[i]] != object)
+        i = (i + 1) & (c->tableSize - 1);
+    return i;
+}
+
+static long FugaC_find(FugaC* c, void* object)
+{
+    return c->table[FugaC_hash(c, object)];
+}
+
+static long FugaC_add(FugaC* c, void* object)
+{
+    if (c->length == c->capacity) {
+        c->capacity = 2 * c->capacity;
+        c->objects  = realloc(c->objects, c->capacity * sizeof(void*));
+    }
+    if (2 * (c->length + 1) > c->tableSize) {
+        free(c->table);
+        c->tableSize = 2 * c->tableSize;
+        c->table = malloc(c->tableSize * sizeof(long));
+        memset(c->table, -1, c->tableSize * sizeof(long));
+        for (size_t i = 0; i < c->length; i++)
+            c->table[FugaC_hash(c, c->objects[i])] = i;
+    }
+    c->table[FugaC_hash(c, object)] = c->length;
+    c->objects[c->length] = object;
+    return c->length++;
+}
+
+static void FugaC_queue(FugaC* c, long code)
+{
+    if (c->queued) {
+        if (c->queued[code])
+            return;
+        c->queued[code] = true;
+    }
+    if (c->queueLength == c->queueCapacity) {
+        c->queueCapacity = 2 * c->queueCapacity;
+        c->queue = realloc(c->queue, c->queueCapacity * sizeof(long));
+    }
+    c->queue[c->queueLength++] = code;
+}
+
+static bool FugaC_isLazy(FugaC* c, void* arg)
+{
+    void* self = c->self;
+    return Fuga_isMsg(arg) && ((FugaMsg*)arg)->name == FUGA_SYMBOL("~");
+}
+
+// Does a msg have only plain args: no names, no docs, and no `~x`?
+static bool FugaC_isPlain(FugaC* c, void* msg)
+{
+    FugaSlots* slots = FUGA_HEADER(msg)->slots;
+    size_t length = slots ? FugaSlots_length(slots) : 0;
+    for (size_t i = 0; i < length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(slots, i);
+        if (slot.name || slot.doc || FugaC_isLazy(c, slot.value))
+            return false;
+    }
+    return true;
+}
+
+static bool FugaC_is(FugaC* c, void* msg, const char* name)
+{
+    void* self = c->self;
+    return Fuga_isMsg(msg) && ((FugaMsg*)msg)->name == FUGA_SYMBOL(name);
+}
+
+/**
+ * Build an object in the module builder, and the objects it holds, and
+ * give it a slot in `O`. Returns the slot, or -1 for an object fugac
+ * can't build.
+ */
+static long FugaC_object(FugaC* c, void* object);
+
+static long FugaC_slots(FugaC* c, long index, void* object)
+{
+    FugaSlots* slots = FUGA_HEADER(object)->slots;
+    size_t length = slots ? FugaSlots_length(slots) : 0;
+    for (size_t i = 0; i < length; i++) {
+        FugaSlot slot = FugaSlots_getByIndex(slots, i);
+        long value = FugaC_object(c, slot.value);
+        if (value < 0)
+            return -1;
+        if (slot.name) {
+            long name = FugaC_object(c, slot.name);
+            if (name < 0)
+                return -1;
+            fprintf(c->build, "    Fuga_set(O[%ld], O[%ld], O[%ld]);\n",
+                    index, name, value);
+        } else {
+            fprintf(c->build, "    Fuga_append_(O[%ld], O[%ld]);\n",
+                    index, value);
+        }
+        if (slot.doc) {
+            long doc = FugaC_object(c, slot.doc);
+            if (doc < 0)
+                return -1;
+            fprintf(c->build, "    Fuga_setDocI(O[%ld], %ld, O[%ld]);\n",
+                    index, (long)i, doc);
+        }
+    }
+    return index;
+}
+
+// `def(sig, stmts...)` and `method(formals, body)` get their body
+// replaced by a compiled body. `def` makes a `do` of several statements
+// when it's called; it's made here instead, so it can be compiled too.
+static long FugaC_def(FugaC* c, void* msg)
+{
+    void* self = c->self;
+    long length = Fuga_length(msg);
+    long index = FugaC_add(c, msg);
+    fprintf(c->build, "    O[%ld] = FugaMsg_fromSymbol(", index);
+    FugaSymbol* name = ((FugaMsg*)msg)->name;
+    fprintf(c->build, "FUGA_SYMBOL(");
+    FugaC_string(c->build, name->data, name->size);
+    fprintf(c->build, "));\n");
+
+    void* head = Fuga_getI(msg, 0);
+    long headIndex = FugaC_object(c, head);
+    if (headIndex < 0)
+        return -1;
+    fprintf(c->build, "    Fuga_append_(O[%ld], O[%ld]);\n",
+            index, headIndex);
+
+    void* body;
+    if (length == 2) {
+        body = Fuga_getI(msg, 1);
+    } else {
+        body = FUGA_MSG("do");
+        for (long i = 1; i < length; i++)
+            Fuga_append_(body, Fuga_getI(msg, i));
+    }
+    long code = FugaC_object(c, body);
+    if (code < 0)
+        return -1;
+    long compiled = FugaC_add(c, Fuga_clone(FUGA->Object));
+    fprintf(c->build,
+            "    O[%ld] = FugaCode_compiled_(O[%ld], fugac_code%ld);\n",
+            compiled, code, code);
+    fprintf(c->build, "    Fuga_append_(O[%ld], O[%ld]);\n",
+            index, compiled);
+    FugaC_queue(c, code);
+    return index;
+}
+
+static long FugaC_object(FugaC* c, void* object)
+{
+    void* self = c->self;
+    long index = FugaC_find(c, object);
+    if (index >= 0)
+        return index;
+
+    if (Fuga_isInt(object)) {
+        long value = ((FugaInt*)object)->value;
+        index = FugaC_add(c, object);
+        if (value == LONG_MIN)
+            fprintf(c->build, "    O[%ld] = FUGA_INT(LONG_MIN);\n", index);
+        else
+            fprintf(c->build, "    O[%ld] = FUGA_INT(%ldL);\n", index, value);
+        if (Fuga_isFrozen(object))
+            fprintf(c->build, "    Fuga_freeze(O[%ld]);\n", index);
+        return index;
+    }
+
+    if (Fuga_isString(object) || Fuga_isSymbol(object)) {
+        bool string = Fuga_isString(object);
+        const char* data = string ? ((FugaString*)object)->data
+                                  : ((FugaSymbol*)object)->data;
+        size_t size = string ? ((FugaString*)object)->size
+                             : ((FugaSymbol*)object)->size;
+        if (memchr(data, 0, size)) {
+            c->error = "can't compile a string with a NUL in it";
+            return -1;
+        }
+        index = FugaC_add(c, object);
+        fprintf(c->build, "    O[%ld] = %s(", index,
+                string ? "FUGA_STRING" : "FUGA_SYMBOL");
+        FugaC_string(c->build, data, size);
+        fprintf(c->build, ");\n");
+        if (Fuga_isFrozen(object))
+            fprintf(c->build, "    Fuga_freeze(O[%ld]);\n", index);
+        return index;
+    }
+
+    if (Fuga_isMsg(object)) {
+        if ((FugaC_is(c, object, "def") && Fuga_length(object) >= 2)
+            || (FugaC_is(c, object, "method") && Fuga_length(object) == 2))
+            if (FugaC_isPlain(c, object))
+                return FugaC_def(c, object);
+        FugaSymbol* name = ((FugaMsg*)object)->name;
+        if (!Fuga_isSymbol(name)) {
+            c->error = "can't compile a msg whose name isn't a symbol";
+            return -1;
+        }
+        index = FugaC_add(c, object);
+        fprintf(c->build, "    O[%ld] = FugaMsg_fromSymbol(FUGA_SYMBOL(",
+                index);
+        FugaC_string(c->build, name->data, name->size);
+        fprintf(c->build, "));\n");
+        return FugaC_slots(c, index, object);
+    }
+
+    if (Fuga_isExpr(object) || FUGA_HEADER(object)->proto == FUGA->Object) {
+        index = FugaC_add(c, object);
+        fprintf(c->build, "    O[%ld] = Fuga_clone(FUGA->%s);\n", index,
+                Fuga_isExpr(object) ? "Expr" : "Object");
+        return FugaC_slots(c, index, object);
+    }
+
+    c->error = "can't compile an object of this type";
+    return -1;
+}
+
+/**
+ * Compile code to statements that evaluate it, in `env`, and give the
+ * temporary that holds the value. Each piece of code that a msg takes as
+ * an arg gets a function of its own (unless it's just a literal or a
+ * name), so that each msg is compiled once however many ways it's sent.
+ */
+static long FugaC_code(FugaC* c, void* code, FugaCEnv* env);
+static long FugaC_msg(FugaC* c, void* msg, FugaCEnv* env);
+
+static long FugaC_var(FugaC* c)
+{
+    return c->vars++;
+}
+
+// Evaluate an arg of a msg, in the scope of the msg.
+static long FugaC_arg(
+    FugaC* c,
+    void* code,
+    const char* scope,
+    const char* tail
+) {
+    FugaCEnv env;
+    strcpy(env.recv,  scope);
+    strcpy(env.scope, scope);
+    env.tail = tail;
+    if (Fuga_isInt(code) || Fuga_isString(code) || Fuga_isSymbol(code)
+                         || (Fuga_isMsg(code) && !Fuga_length(code)))
+        return FugaC_code(c, code, &env);
+
+    long index  = FugaC_find(c, code);
+    long result = FugaC_var(c);
+    FugaC_queue(c, index);
+    FugaC_line(c, "void* v%ld = fugac_code%ld(%s, %s, %s);",
+               result, index, scope, scope, tail);
+    FugaC_line(c, "FUGA_CHECK(v%ld);", result);
+    return result;
+}
+
+// The value of an `if` branch, as FugaPrelude_branch gives it.
+static void FugaC_branch(
+    FugaC* c,
+    void* code,
+    long result,
+    FugaCEnv* env
+) {
+    long value = FugaC_arg(c, code, env->scope, env->tail);
+    if (!strcmp(env->tail, "false"))
+        FugaC_line(c, "FUGA_NEED(v%ld);", value);
+    else if (strcmp(env->tail, "true"))
+        FugaC_line(c, "if (!%s) FUGA_NEED(v%ld);", env->tail, value);
+    FugaC_line(c, "v%ld = v%ld;", result, value);
+}
+
+// `if`, from its `i`th arg on.
+static void FugaC_if(FugaC* c, void* msg, long i, long result, FugaCEnv* env)
+{
+    long length = Fuga_length(msg);
+    if (i == length) {
+        FugaC_line(c, "v%ld = FUGA->nil;", result);
+        return;
+    }
+    if (i == length - 1) {
+        FugaC_branch(c, Fuga_getI(msg, i), result, env);
+        return;
+    }
+    long cond = FugaC_arg(c, Fuga_getI(msg, i), env->scope, "false");
+    FugaC_line(c, "FUGA_NEED(v%ld);", cond);
+    FugaC_line(c, "if (Fuga_isTrue(v%ld)) {", cond);
+    c->indent++;
+    FugaC_branch(c, Fuga_getI(msg, i + 1), result, env);
+    c->indent--;
+    FugaC_line(c, "} else {");
+    c->indent++;
+    FugaC_line(c, "if (!Fuga_isFalse(v%ld))", cond);
+    FugaC_line(c, "    FUGA_RAISE(FUGA->TypeError,");
+    FugaC_line(c, "        \"if: expected condition to be boolean\");");
+    FugaC_if(c, msg, i + 2, result, env);
+    c->indent--;
+    FugaC_line(c, "}");
+}
+
+// `do`: its statements, in a scope of their own.
+static void FugaC_do(FugaC* c, void* msg, long result, FugaCEnv* env)
+{
+    long length = Fuga_length(msg);
+    long scope  = FugaC_var(c);
+    char name[24];
+    sprintf(name, "v%ld", scope);
+    FugaC_line(c, "void* %s = Fuga_clone(%s);", name, env->scope);
+    FugaC_line(c, "FUGA_CHECK(%s);", name);
+    FugaC_line(c, "FUGA_CHECK(Fuga_setS(%s, \"_this\", %s));", name, name);
+    long value = -1;
+    for (long i = 0; i < length; i++) {
+        void* code = Fuga_getI(msg, i);
+        bool last = i == length - 1;
+        if (!last && (Fuga_isInt(code) || Fuga_isString(code)
+                                       || Fuga_isSymbol(code)))
+            continue;
+        value = FugaC_arg(c, code, name, last ? env->tail : "false");
+    }
+    FugaC_line(c, "v%ld = v%ld;", result, value);
+}
+
+// An operator: the left operand, then the right one if the operator
+// fuses with it, else the operator's method.
+static void FugaC_op(FugaC* c, void* msg, long value, long result,
+                     FugaCEnv* env)
+{
+    long index = FugaC_find(c, msg);
+    long left  = FugaC_arg(c, Fuga_getI(msg, 0), env->scope, "false");
+    FugaC_line(c, "FUGA_NEED(v%ld);", left);
+    FugaC_line(c, "if (FugaMethodOp_fuses(v%ld, v%ld)) {", value, left);
+    c->indent++;
+    long right = FugaC_arg(c, Fuga_getI(msg, 1), env->scope, "false");
+    FugaC_line(c, "FUGA_NEED(v%ld);", right);
+    FugaC_line(c, "v%ld = FugaMethodOp_fuse(v%ld, v%ld, v%ld);",
+               result, value, left, right);
+    c->indent--;
+    FugaC_line(c, "} else {");
+    FugaC_line(c, "    v%ld = FugaMethodOp_sendFrom(v%ld, O[%ld], %s, v%ld);",
+               result, value, index, env->scope, left);
+    FugaC_line(c, "}");
+}
+
+// A strict method, with its args evaluated the way FugaCode_evalArgs
+// would: nil args are left out.
+static void FugaC_strict(FugaC* c, void* msg, long value, long result,
+                         FugaCEnv* env)
+{
+    long length = Fuga_length(msg);
+    if (!length) {
+        FugaC_line(c, "v%ld = FugaMethod_callStrict(v%ld, %s, 0, NULL);",
+                   result, value, env->recv);
+        return;
+    }
+    long argv = FugaC_var(c);
+    FugaC_line(c, "void* v%ld[%d];", argv, FUGA_METHOD_ARGC);
+    FugaC_line(c, "size_t v%ldc = 0;", argv);
+    for (long i = 0; i < length; i++) {
+        long arg = FugaC_arg(c, Fuga_getI(msg, i), env->scope, "false");
+        FugaC_line(c, "if (!Fuga_isNil(v%ld))", arg);
+        FugaC_line(c, "    v%ld[v%ldc++] = v%ld;", argv, argv, arg);
+    }
+    FugaC_line(c, "v%ld = FugaMethod_callStrict(v%ld, %s, v%ldc, v%ld);",
+               result, value, env->recv, argv, argv);
+}
+
+static long FugaC_msg(FugaC* c, void* msg, FugaCEnv* env)
+{
+    long index  = FugaC_find(c, msg);
+    long length = Fuga_length(msg);
+    bool plain  = FugaC_isPlain(c, msg);
+    long value  = FugaC_var(c);
+    long result = FugaC_var(c);
+
+    FugaC_line(c, "void* v%ld = FugaMsg_resolve(O[%ld], %s, %s);",
+               value, index, env->recv, env->scope);
+    FugaC_line(c, "FUGA_CHECK(v%ld);", value);
+    FugaC_line(c, "void* v%ld;", result);
+
+    if (!length) {
+        FugaC_line(c, "if (!Fuga_isMethod(v%ld)) {", value);
+        FugaC_line(c, "    v%ld = v%ld;", result, value);
+        FugaC_line(c, "} else");
+    }
+    if (plain && length >= 2) {
+        FugaC_line(c, "if (FugaMethodT_is_(v%ld, FugaPrelude_if)) {", value);
+        c->indent++;
+        FugaC_if(c, msg, 0, result, env);
+        c->indent--;
+        FugaC_line(c, "} else");
+    }
+    if (plain && length >= 1) {
+        FugaC_line(c, "if (FugaMethodT_is_(v%ld, FugaPrelude_do)) {", value);
+        c->indent++;
+        FugaC_do(c, msg, result, env);
+        c->indent--;
+        FugaC_line(c, "} else");
+    }
+    if (plain && length == 2) {
+        FugaC_line(c, "if (FugaMethodOp_op(v%ld)) {", value);
+        c->indent++;
+        FugaC_op(c, msg, value, result, env);
+        c->indent--;
+        FugaC_line(c, "} else");
+    }
+    if (plain && length <= FUGA_METHOD_ARGC) {
+        FugaC_line(c, "if (FugaMethod_isStrict(v%ld)) {", value);
+        c->indent++;
+        FugaC_strict(c, msg, value, result, env);
+        c->indent--;
+        FugaC_line(c, "} else");
+    }
+    FugaC_line(c, "%sv%ld = FugaMsg_apply(O[%ld], v%ld, %s, %s, %s);",
+               length && !plain ? "" : "    ", result, index, value,
+               env->recv, env->scope, env->tail);
+    FugaC_line(c, "FUGA_CHECK(v%ld);", result);
+    return result;
+}
+
+// Can an expression be compiled part by part? Only if its parts are msgs
+// and literals, each sent to the value of the one before it.
+static bool FugaC_isChain(void* expr)
+{
+    long length = Fuga_length(expr);
+    if (!length)
+        return false;
+    for (long i = 0; i < length; i++) {
+        void* part = Fuga_getI(expr, i);
+        if (!Fuga_isMsg(part) && !Fuga_isInt(part) && !Fuga_isString(part)
+                              && !Fuga_isSymbol(part))
+            return false;
+    }
+    return true;
+}
+
+static long FugaC_code(FugaC* c, void* code, FugaCEnv* env)
+{
+    long index = FugaC_find(c, code);
+    if (Fuga_isInt(code) || Fuga_isString(code) || Fuga_isSymbol(code)) {
+        long result = FugaC_var(c);
+        FugaC_line(c, "void* v%ld = O[%ld];", result, index);
+        return result;
+    }
+
+    if (Fuga_isMsg(code))
+        return FugaC_msg(c, code, env);
+
+    if (Fuga_isExpr(code) && FugaC_isChain(code)) {
+        long length = Fuga_length(code);
+        long recv = FugaC_var(c);
+        FugaC_line(c, "void* v%ld = %s;", recv, env->recv);
+        for (long i = 0; i < length; i++) {
+            void* part = Fuga_getI(code, i);
+            FugaC_line(c, "FUGA_NEED(v%ld);", recv);
+            FugaCEnv partEnv = *env;
+            sprintf(partEnv.recv, "v%ld", recv);
+            partEnv.tail = i == length - 1 ? env->tail : "false";
+            recv = FugaC_code(c, part, &partEnv);
+        }
+        return recv;
+    }
+
+    long result = FugaC_var(c);
+    if (!strcmp(env->tail, "false"))
+        FugaC_line(c, "void* v%ld = Fuga_eval(O[%ld], %s, %s);",
+                   result, index, env->recv, env->scope);
+    else
+        FugaC_line(c, "void* v%ld = %s ? FugaCode_evalTail(O[%ld], %s, %s)"
+                      " : Fuga_eval(O[%ld], %s, %s);",
+                   result, env->tail, index, env->recv, env->scope,
+                   index, env->recv, env->scope);
+    FugaC_line(c, "FUGA_CHECK(v%ld);", result);
+    return result;
+}
+
+static void FugaC_function(FugaC* c, long index)
+{
+    FugaCEnv env = {.recv = "recv", .scope = "scope", .tail = "tail"};
+    c->vars = 0;
+    c->indent = 1;
+    fprintf(c->out, "\nstatic void* fugac_code%ld(void* recv, void* scope,"
+                    " bool tail)\n{\n", index);
+    FugaC_line(c, "void* self = scope;");
+    FugaC_line(c, "(void) self;");
+    long result = FugaC_code(c, c->objects[index], &env);
+    FugaC_line(c, "return v%ld;", result);
+    fprintf(c->out, "}\n");
+}
+
+static void FugaC_copy(FILE* from, FILE* to)
+{
+    int ch;
+    rewind(from);
+    while ((ch = fgetc(from)) != EOF)
+        fputc(ch, to);
+    fclose(from);
+}
+
+static int FugaC_compile(void* self, const char* filename, FILE* out)
+{
+    FugaParser* parser = FugaParser_new(self);
+    if (!FugaParser_readFile_(parser, filename)) {
+        fprintf(stderr, "fugac: can't read %s\n", filename);
+        return 1;
+    }
+    void* block = FugaParser_block(parser);
+    if (Fuga_isRaised(block)) {
+        Fuga_printException(Fuga_catch(block));
+        return 1;
+    }
+
+    FugaC c = {
+        .self      = self,
+        .build     = tmpfile(),
+        .functions = tmpfile(),
+        .capacity  = 64,
+        .tableSize = 64,
+        .queueCapacity = 64,
+    };
+    if (!c.build || !c.functions) {
+        fprintf(stderr, "fugac: can't make a temporary file\n");
+        return 1;
+    }
+    c.objects = malloc(c.capacity * sizeof(void*));
+    c.table   = malloc(c.tableSize * sizeof(long));
+    c.queue   = malloc(c.queueCapacity * sizeof(long));
+    memset(c.table, -1, c.tableSize * sizeof(long));
+
+    // Build the module, then compile the method bodies, and the code
+    // they take as args, as it turns up.
+    long module = FugaC_object(&c, block);
+    if (module < 0) {
+        fprintf(stderr, "fugac: %s: %s\n", filename, c.error);
+        return 1;
+    }
+    c.queued = calloc(c.length, sizeof(bool));
+    size_t bodies = c.queueLength;
+    c.queueLength = 0;
+    for (size_t i = 0; i < bodies; i++)
+        FugaC_queue(&c, c.queue[i]);
+    c.out = c.functions;
+    for (size_t i = 0; i < c.queueLength; i++)
+        FugaC_function(&c, c.queue[i]);
+
+    fprintf(out, "// Compiled from %s by fugac.\n\n", filename);
+    fprintf(out, "#include \"fuga/fuga.h\"\n");
+    fprintf(out, "#include \"fuga/code.h\"\n");
+    fprintf(out, "#include \"fuga/method.h\"\n");
+    fprintf(out, "#include \"fuga/msg.h\"\n");
+    fprintf(out, "#include \"fuga/prelude.h\"\n\n");
+    fprintf(out, "#include <limits.h>\n\n");
+    fprintf(out, "static void* O[%ld];\n\n", (long)c.length);
+    for (size_t i = 0; i < c.queueLength; i++)
+        fprintf(out, "static void* fugac_code%ld(void* recv, void* scope,"
+                     " bool tail);\n", c.queue[i]);
+
+    fprintf(out, "\nstatic void* fugac_module(void* self)\n{\n");
+    FugaC_copy(c.build, out);
+    fprintf(out, "    return O[%ld];\n}\n", module);
+    FugaC_copy(c.functions, out);
+
+    fprintf(out, "\nint main(void)\n{\n");
+    fprintf(out, "    void* self   = Fuga_init();\n");
+    fprintf(out, "    void* result = Fuga_evalModule_(fugac_module(self), ");
+    FugaC_string(out, filename, strlen(filename));
+    fprintf(out, ");\n");
+    fprintf(out, "    void* error  = Fuga_catch(result);\n");
+    fprintf(out, "    if (error)\n");
+    fprintf(out, "        Fuga_printException(error);\n");
+    fprintf(out, "    return 0;\n}\n");
+
+    free(c.objects);
+    free(c.table);
+    free(c.queue);
+    free(c.queued);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "Usage: %s module.fg [out.c]\n", argv[0]);
+        return 2;
+    }
+    FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "fugac: can't write %s\n", argv[2]);
+        return 1;
+    }
+    void* self = Fuga_init();
+    int status = FugaC_compile(self, argv[1], out);
+    if (out != stdout)
+        fclose(out);
+    Fuga_quit(self);
+    return status;
+}